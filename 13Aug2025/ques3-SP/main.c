@@ -2,184 +2,963 @@
  * Random Maze Generator and Solver
  *
  * TIME COMPLEXITY ANALYSIS:
- * - Maze Generation: O(WIDTH * HEIGHT) - Each cell is visited a constant number of times.
- * - Maze Solving: O(WIDTH * HEIGHT) - In the worst case, the backtracking algorithm visits each cell once.
+ * - Maze Generation: O(W * H) - Each cell is visited a constant number of times.
+ * - Maze Solving: O(W * H) - In the worst case, the backtracking algorithm visits each cell once.
+ * - Rendering / saving: O(W * H) bytes, written in large blocks (one fwrite per buffer, not per cell).
  *
  * SPACE COMPLEXITY ANALYSIS:
- * - O(WIDTH * HEIGHT) for the maze grid.
- * - O(WIDTH * HEIGHT) for the recursion stack depth in the worst case.
- * - Total: O(WIDTH * HEIGHT)
+ * - O(W * H) for the maze grid.
+ * - O(W * H) for the explicit DFS stacks in the worst case (no recursion, so large mazes
+ *   do not overflow the call stack).
+ * - Total: O(W * H)
  *
  * ALGORITHM:
- * - Generation: Randomized Depth-First Search (DFS). It carves paths by recursively visiting neighbors in a random order.
+ * - Generation: Randomized Depth-First Search (DFS). It carves paths by walking to a random unvisited
+ *   neighbor and backtracking (via an explicit stack) when a cell has none left.
  * - Solving: Backtracking. It explores paths from start to end, marking the correct path and backtracking from dead ends.
+ * - Randomness: a per-instance xoshiro256** generator (seeded through splitmix64) is passed through the
+ *   generator instead of the global rand(), so a given 64-bit seed always reproduces the same maze.
+ * - Output: text rows are copied into a 1 MB buffer and flushed with fwrite; the maze can also be saved
+ *   as a binary PGM/PBM image or as a bit-packed dump that load_maze_binary() reads back.
+ * - Path queries: a perfect maze is a spanning tree of its open cells, so the path between any two cells
+ *   is unique. build_path_index() roots the tree at the entrance and builds a sparse table over the DFS
+ *   preorder; the lowest common ancestor, and so the distance, of any two cells is then an O(1) lookup
+ *   after O(n log n) preprocessing, and the path itself is extracted on demand in O(length).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <stdbool.h> // For using bool, true, and false
 
 // --- Maze Constants ---
-#define WIDTH 31         // Must be an odd number
-#define HEIGHT 21        // Must be an odd number
+#define WIDTH 31         // Default width, must be an odd number
+#define HEIGHT 21        // Default height, must be an odd number
 #define WALL '#'
 #define PATH ' '
 #define START 'S'
 #define END 'E'
 #define SOLUTION_PATH '.'
 
-// --- Global Data Structures ---
-char maze[HEIGHT][WIDTH]; // Global grid for the maze
+#define RENDER_BUFFER_SIZE (1 << 20)   // Bytes collected before each fwrite
+#define DUMP_MAGIC "MAZ1"              // Header tag of the binary dump format
+#define QUERY_OPEN_FAILED (-1)         // run_query_file: the query file cannot be opened
+#define QUERY_OUT_OF_MEMORY (-2)       // run_query_file: no memory for a path
 
 // Structure to hold coordinates for cleaner code
 typedef struct {
     int r, c;
 } Point;
 
+// --- Maze Data Structure ---
+// The grid is one heap block of height * width characters (row-major), so the
+// size is chosen at run time and a row is a contiguous run of bytes.
+typedef struct {
+    int width, height;   // Both odd
+    Point start, end;    // Entrance and exit cells (on the border)
+    char *cells;
+} Maze;
+
+// Access the character at (r, c)
+#define CELL(m, r, c) ((m)->cells[(size_t)(r) * (size_t)(m)->width + (size_t)(c)])
+
+// Pseudo-random number generator state (xoshiro256**).
+// Each generator owns its state, so several mazes can be built side by side
+// without sharing (or locking) the hidden state of rand().
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+/*
+ * Function: splitmix64
+ * Purpose: Advances a 64-bit counter and returns a well-mixed value.
+ * Used only to expand a single user seed into the 256-bit xoshiro state.
+ */
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/*
+ * Function: rng_seed
+ * Purpose: Initializes a generator from an explicit 64-bit seed.
+ * The same seed always produces the same sequence (and therefore the same maze).
+ */
+void rng_seed(Rng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&seed);
+    }
+}
+
+/*
+ * Function: rng_next
+ * Purpose: Returns the next 64 random bits (xoshiro256**).
+ */
+uint64_t rng_next(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+
+    return result;
+}
+
+/*
+ * Function: rng_bounded
+ * Purpose: Returns a uniformly distributed integer in [0, bound).
+ * Algorithm: Lemire's multiply-shift with rejection. Unlike `rand() % bound`
+ * it uses the high bits and has no modulo bias; the rejection branch is
+ * taken with probability < bound / 2^32.
+ */
+uint32_t rng_bounded(Rng *rng, uint32_t bound) {
+    uint32_t x = (uint32_t)(rng_next(rng) >> 32);
+    uint64_t m = (uint64_t)x * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            x = (uint32_t)(rng_next(rng) >> 32);
+            m = (uint64_t)x * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+/*
+ * Function: maze_create
+ * Purpose: Allocates a width x height grid and sets the default entrance/exit.
+ * Returns: true on success, false if the size is invalid or allocation fails.
+ */
+bool maze_create(Maze *m, int width, int height) {
+    if (width < 3 || height < 3 || width % 2 == 0 || height % 2 == 0) {
+        return false;
+    }
+    m->width = width;
+    m->height = height;
+    m->start = (Point){1, 0};
+    m->end = (Point){height - 2, width - 1};
+    m->cells = malloc((size_t)width * (size_t)height);
+    return m->cells != NULL;
+}
+
+/*
+ * Function: maze_free
+ * Purpose: Releases the grid owned by a maze.
+ */
+void maze_free(Maze *m) {
+    free(m->cells);
+    m->cells = NULL;
+}
+
 /*
  * Function: initialize_maze
  * Purpose: Fills the entire maze grid with WALL characters to start.
  */
-void initialize_maze() {
-    for (int r = 0; r < HEIGHT; r++) {
-        for (int c = 0; c < WIDTH; c++) {
-            maze[r][c] = WALL;
+void initialize_maze(Maze *m) {
+    memset(m->cells, WALL, (size_t)m->width * (size_t)m->height);
+}
+
+/*
+ * Function: write_maze_text
+ * Purpose: Writes the maze as text rows to a stream.
+ * Each row is copied into a large buffer with memcpy, and the buffer is
+ * flushed with a single fwrite whenever it fills up, instead of one
+ * printf("%c") call per cell.
+ * Returns: true if every write succeeded.
+ */
+bool write_maze_text(const Maze *m, FILE *out) {
+    size_t row_len = (size_t)m->width + 1;   // Row plus newline
+    size_t cap = row_len > RENDER_BUFFER_SIZE ? row_len : RENDER_BUFFER_SIZE;
+    char *buffer = malloc(cap);
+    if (!buffer) {
+        return false;
+    }
+
+    bool ok = true;
+    size_t used = 0;
+    for (int r = 0; r < m->height && ok; r++) {
+        if (used + row_len > cap) {
+            ok = fwrite(buffer, 1, used, out) == used;
+            used = 0;
         }
+        memcpy(buffer + used, &CELL(m, r, 0), (size_t)m->width);
+        used += (size_t)m->width;
+        buffer[used++] = '\n';
+    }
+    if (ok && used > 0) {
+        ok = fwrite(buffer, 1, used, out) == used;
     }
+
+    free(buffer);
+    return ok;
 }
 
 /*
  * Function: print_maze
  * Purpose: Displays the current state of the maze grid to the console.
  */
-void print_maze() {
-    for (int r = 0; r < HEIGHT; r++) {
-        for (int c = 0; c < WIDTH; c++) {
-            printf("%c", maze[r][c]);
+void print_maze(const Maze *m) {
+    write_maze_text(m, stdout);
+    printf("\n");
+}
+
+/*
+ * Function: pgm_shade
+ * Purpose: Maps a maze character to an 8-bit grey level for PGM output.
+ */
+static unsigned char pgm_shade(char cell) {
+    switch (cell) {
+        case WALL:          return 0;
+        case SOLUTION_PATH: return 128;
+        case START:
+        case END:           return 64;
+        default:            return 255;
+    }
+}
+
+/*
+ * Function: write_maze_pgm
+ * Purpose: Saves the maze as a binary greyscale image (PGM, "P5").
+ * Walls are black, open cells white, the solution path grey.
+ * One pixel per cell; rows are converted into a buffer and written in blocks.
+ * Returns: true on success.
+ */
+bool write_maze_pgm(const Maze *m, const char *filename) {
+    FILE *out = fopen(filename, "wb");
+    if (!out) {
+        return false;
+    }
+    fprintf(out, "P5\n%d %d\n255\n", m->width, m->height);
+
+    size_t row_len = (size_t)m->width;
+    size_t cap = row_len > RENDER_BUFFER_SIZE ? row_len : RENDER_BUFFER_SIZE;
+    unsigned char *buffer = malloc(cap);
+    bool ok = buffer != NULL;
+    size_t used = 0;
+    for (int r = 0; r < m->height && ok; r++) {
+        if (used + row_len > cap) {
+            ok = fwrite(buffer, 1, used, out) == used;
+            used = 0;
+        }
+        const char *row = &CELL(m, r, 0);
+        for (int c = 0; c < m->width; c++) {
+            buffer[used++] = pgm_shade(row[c]);
         }
-        printf("\n");
     }
-    printf("\n");
+    if (ok && used > 0) {
+        ok = fwrite(buffer, 1, used, out) == used;
+    }
+
+    free(buffer);
+    return fclose(out) == 0 && ok;
 }
 
 /*
- * Function: shuffle
- * Purpose: Randomizes the order of an array of points.
- * Parameters: array - The array of Point structs to shuffle.
- * n - The number of elements in the array.
- * Algorithm: Fisher-Yates shuffle algorithm.
+ * Function: pack_wall_row
+ * Purpose: Packs one maze row into bits, MSB first, 1 = wall.
+ * This is both the PBM ("P4") row layout and the row layout of the binary dump.
  */
-void shuffle(Point array[], int n) {
-    for (int i = n - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        Point temp = array[i];
-        array[i] = array[j];
-        array[j] = temp;
+static void pack_wall_row(const Maze *m, int r, unsigned char *dst) {
+    const char *row = &CELL(m, r, 0);
+    size_t bytes = ((size_t)m->width + 7) / 8;
+    memset(dst, 0, bytes);
+    for (int c = 0; c < m->width; c++) {
+        if (row[c] == WALL) {
+            dst[c >> 3] |= (unsigned char)(0x80 >> (c & 7));
+        }
     }
 }
 
+/*
+ * Function: write_packed_rows
+ * Purpose: Writes every row of the maze as packed wall bits, buffering many rows per fwrite.
+ * Returns: true if every write succeeded.
+ */
+static bool write_packed_rows(const Maze *m, FILE *out) {
+    size_t row_len = ((size_t)m->width + 7) / 8;
+    size_t cap = row_len > RENDER_BUFFER_SIZE ? row_len : RENDER_BUFFER_SIZE;
+    unsigned char *buffer = malloc(cap);
+    bool ok = buffer != NULL;
+    size_t used = 0;
+    for (int r = 0; r < m->height && ok; r++) {
+        if (used + row_len > cap) {
+            ok = fwrite(buffer, 1, used, out) == used;
+            used = 0;
+        }
+        pack_wall_row(m, r, buffer + used);
+        used += row_len;
+    }
+    if (ok && used > 0) {
+        ok = fwrite(buffer, 1, used, out) == used;
+    }
+    free(buffer);
+    return ok;
+}
+
+/*
+ * Function: write_maze_pbm
+ * Purpose: Saves the maze as a binary bitmap (PBM, "P4"), one bit per cell, walls black.
+ * Returns: true on success.
+ */
+bool write_maze_pbm(const Maze *m, const char *filename) {
+    FILE *out = fopen(filename, "wb");
+    if (!out) {
+        return false;
+    }
+    fprintf(out, "P4\n%d %d\n", m->width, m->height);
+    bool ok = write_packed_rows(m, out);
+    return fclose(out) == 0 && ok;
+}
+
+// Little-endian helpers for the binary dump header (independent of host byte order)
+static void put_u32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*
+ * Function: save_maze_binary
+ * Purpose: Saves the maze in a compact reloadable format.
+ * Layout: "MAZ1", then width, height, start.r, start.c, end.r, end.c as
+ * little-endian uint32, then the walls as packed bits (one bit per cell,
+ * rows padded to a byte). The solution path is not stored; it can be
+ * recomputed after loading.
+ * Returns: true on success.
+ */
+bool save_maze_binary(const Maze *m, const char *filename) {
+    FILE *out = fopen(filename, "wb");
+    if (!out) {
+        return false;
+    }
+    unsigned char header[28];
+    memcpy(header, DUMP_MAGIC, 4);
+    put_u32(header + 4, (uint32_t)m->width);
+    put_u32(header + 8, (uint32_t)m->height);
+    put_u32(header + 12, (uint32_t)m->start.r);
+    put_u32(header + 16, (uint32_t)m->start.c);
+    put_u32(header + 20, (uint32_t)m->end.r);
+    put_u32(header + 24, (uint32_t)m->end.c);
+
+    bool ok = fwrite(header, 1, sizeof(header), out) == sizeof(header) && write_packed_rows(m, out);
+    return fclose(out) == 0 && ok;
+}
+
+/*
+ * Function: load_maze_binary
+ * Purpose: Reads a maze written by save_maze_binary into a newly allocated grid.
+ * Returns: true on success; on failure the maze is left unallocated.
+ */
+bool load_maze_binary(Maze *m, const char *filename) {
+    FILE *in = fopen(filename, "rb");
+    if (!in) {
+        return false;
+    }
+    unsigned char header[28];
+    if (fread(header, 1, sizeof(header), in) != sizeof(header) || memcmp(header, DUMP_MAGIC, 4) != 0) {
+        fclose(in);
+        return false;
+    }
+    uint32_t width = get_u32(header + 4);
+    uint32_t height = get_u32(header + 8);
+    if (width > INT32_MAX || height > INT32_MAX || !maze_create(m, (int)width, (int)height)) {
+        fclose(in);
+        return false;
+    }
+    // Range-check the raw fields before they become (signed) coordinates
+    uint32_t start_r = get_u32(header + 12), start_c = get_u32(header + 16);
+    uint32_t end_r = get_u32(header + 20), end_c = get_u32(header + 24);
+    if (start_r >= height || start_c >= width || end_r >= height || end_c >= width) {
+        maze_free(m);
+        fclose(in);
+        return false;
+    }
+    m->start = (Point){(int)start_r, (int)start_c};
+    m->end = (Point){(int)end_r, (int)end_c};
+
+    size_t row_len = ((size_t)width + 7) / 8;
+    unsigned char *row = malloc(row_len);
+    bool ok = row != NULL;
+    for (int r = 0; r < m->height && ok; r++) {
+        ok = fread(row, 1, row_len, in) == row_len;
+        for (int c = 0; c < m->width && ok; c++) {
+            CELL(m, r, c) = (row[c >> 3] & (0x80 >> (c & 7))) ? WALL : PATH;
+        }
+    }
+    free(row);
+    fclose(in);
+
+    if (!ok) {
+        maze_free(m);
+        return false;
+    }
+    CELL(m, m->start.r, m->start.c) = START;
+    CELL(m, m->end.r, m->end.c) = END;
+    return true;
+}
+
 /*
  * Function: generate_maze
- * Purpose: Recursively carves paths into the maze using Randomized DFS.
- * Parameters: r - The current row of the generation algorithm.
- * c - The current column of the generation algorithm.
+ * Purpose: Carves paths into the maze using Randomized DFS.
+ * Parameters: m - The maze to carve (must be all walls).
+ * r - The starting row (odd).
+ * c - The starting column (odd).
+ * rng - The generator used to pick the neighbors.
+ * Algorithm: Iterative recursive-backtracker. The top of an explicit stack is
+ * the current cell; a random unvisited neighbor (2 cells away) is carved and
+ * pushed, and a cell with no unvisited neighbors is popped (backtrack).
+ * Returns: false only if the stack could not be allocated.
  */
-void generate_maze(int r, int c) {
-    maze[r][c] = PATH; // Mark the current cell as a path
+bool generate_maze(Maze *m, int r, int c, Rng *rng) {
+    size_t max_depth = ((size_t)(m->width / 2)) * ((size_t)(m->height / 2));
+    Point *stack = malloc(max_depth * sizeof(Point));
+    if (!stack) {
+        return false;
+    }
+
+    size_t top = 0;
+    stack[top++] = (Point){r, c};
+    CELL(m, r, c) = PATH; // Mark the starting cell as a path
 
-    // Find all valid neighbors (2 cells away) that are still walls
-    Point neighbors[4];
-    int count = 0;
-    if (r >= 2 && maze[r - 2][c] == WALL) neighbors[count++] = (Point){r - 2, c};
-    if (r < HEIGHT - 2 && maze[r + 2][c] == WALL) neighbors[count++] = (Point){r + 2, c};
-    if (c >= 2 && maze[r][c - 2] == WALL) neighbors[count++] = (Point){r, c - 2};
-    if (c < WIDTH - 2 && maze[r][c + 2] == WALL) neighbors[count++] = (Point){r, c + 2};
+    while (top > 0) {
+        Point cur = stack[top - 1];
 
-    // Shuffle the neighbors to ensure randomness
-    shuffle(neighbors, count);
+        // Find all valid neighbors (2 cells away) that are still walls
+        Point neighbors[4];
+        int count = 0;
+        if (cur.r >= 2 && CELL(m, cur.r - 2, cur.c) == WALL) neighbors[count++] = (Point){cur.r - 2, cur.c};
+        if (cur.r < m->height - 2 && CELL(m, cur.r + 2, cur.c) == WALL) neighbors[count++] = (Point){cur.r + 2, cur.c};
+        if (cur.c >= 2 && CELL(m, cur.r, cur.c - 2) == WALL) neighbors[count++] = (Point){cur.r, cur.c - 2};
+        if (cur.c < m->width - 2 && CELL(m, cur.r, cur.c + 2) == WALL) neighbors[count++] = (Point){cur.r, cur.c + 2};
 
-    // Recursively visit each neighbor
-    for (int i = 0; i < count; i++) {
-        Point next = neighbors[i];
-        if (maze[next.r][next.c] == WALL) {
-            // Carve the path between the current cell and the chosen neighbor
-            maze[(r + next.r) / 2][(c + next.c) / 2] = PATH;
-            generate_maze(next.r, next.c);
+        if (count == 0) {
+            top--; // Dead end: backtrack
+            continue;
         }
+
+        // Carve the path between the current cell and a random neighbor
+        Point next = neighbors[count == 1 ? 0 : rng_bounded(rng, (uint32_t)count)];
+        CELL(m, (cur.r + next.r) / 2, (cur.c + next.c) / 2) = PATH;
+        CELL(m, next.r, next.c) = PATH;
+        stack[top++] = next;
     }
+
+    free(stack);
+    return true;
 }
 
 /*
  * Function: solve_maze
- * Purpose: Recursively finds a path from a given point to the exit.
- * Parameters: r - The current row of the solver.
- * c - The current column of the solver.
+ * Purpose: Finds a path from the entrance to the exit and marks it.
+ * Algorithm: Backtracking with an explicit stack. Each stack entry remembers
+ * which of the four directions (down, right, up, left) it tries next; a cell
+ * whose directions are exhausted is un-marked and popped.
  * Returns: true if a path to the end is found, false otherwise.
  */
-bool solve_maze(int r, int c) {
-    // Base Case: Success! We have reached the end of the maze.
-    if (r == HEIGHT - 2 && c == WIDTH - 1) {
-        maze[r][c] = END;
-        return true;
+bool solve_maze(Maze *m) {
+    static const int dr[4] = {1, 0, -1, 0};
+    static const int dc[4] = {0, 1, 0, -1};
+
+    size_t cells = (size_t)m->width * (size_t)m->height;
+    Point *stack = malloc(cells * sizeof(Point));
+    unsigned char *next_dir = malloc(cells);
+    if (!stack || !next_dir) {
+        free(stack);
+        free(next_dir);
+        return false;
     }
 
-    // Check for invalid moves: out of bounds, into a wall, or onto an existing path
-    if (r < 0 || r >= HEIGHT || c < 0 || c >= WIDTH || maze[r][c] == WALL || maze[r][c] == SOLUTION_PATH) {
+    bool found = false;
+    size_t top = 0;
+    stack[top] = m->start;
+    next_dir[top++] = 0;
+    CELL(m, m->start.r, m->start.c) = SOLUTION_PATH;
+
+    while (top > 0) {
+        Point cur = stack[top - 1];
+
+        // Success! We have reached the end of the maze.
+        if (cur.r == m->end.r && cur.c == m->end.c) {
+            CELL(m, cur.r, cur.c) = END;
+            found = true;
+            break;
+        }
+
+        if (next_dir[top - 1] == 4) {
+            // Backtrack: no direction led to a solution, this path is a dead end.
+            CELL(m, cur.r, cur.c) = PATH;
+            top--;
+            continue;
+        }
+
+        int d = next_dir[top - 1]++;
+        int r = cur.r + dr[d];
+        int c = cur.c + dc[d];
+
+        // Skip invalid moves: out of bounds, into a wall, or onto an existing path
+        if (r < 0 || r >= m->height || c < 0 || c >= m->width ||
+            CELL(m, r, c) == WALL || CELL(m, r, c) == SOLUTION_PATH) {
+            continue;
+        }
+
+        // Place a marker on the cell as part of the potential solution
+        CELL(m, r, c) = SOLUTION_PATH;
+        stack[top] = (Point){r, c};
+        next_dir[top++] = 0;
+    }
+
+    free(stack);
+    free(next_dir);
+    return found;
+}
+
+// --- Path Query Index ---
+// Rooted view of the maze tree. Every array is indexed by cell (r * width + c);
+// walls and cells not connected to the root have tin == -1.
+typedef struct {
+    const Maze *maze;
+    int32_t *parent;   // Parent cell, -1 for the root
+    int32_t *depth;    // Distance (in steps) from the root
+    int32_t *tin;      // Position of the cell in the DFS preorder
+    int32_t *order;    // order[k] = cell at preorder position k
+    int32_t **sparse;  // sparse[j][k] = shallowest cell among order[k .. k + 2^j)
+    int levels;        // Number of sparse table rows
+    size_t count;      // Number of cells in the tree
+} PathIndex;
+
+/*
+ * Function: free_path_index
+ * Purpose: Releases everything owned by a path index.
+ */
+void free_path_index(PathIndex *idx) {
+    if (idx->sparse) {
+        // Row 0 aliases idx->order, so it is freed with it below
+        for (int j = 1; j < idx->levels; j++) {
+            free(idx->sparse[j]);
+        }
+    }
+    free(idx->sparse);
+    free(idx->parent);
+    free(idx->depth);
+    free(idx->tin);
+    free(idx->order);
+    memset(idx, 0, sizeof(*idx));
+}
+
+static inline int32_t shallower(const PathIndex *idx, int32_t a, int32_t b) {
+    return idx->depth[a] <= idx->depth[b] ? a : b;
+}
+
+/*
+ * Function: build_path_index
+ * Purpose: Roots the maze tree at root and prepares O(1) LCA queries.
+ * Steps:
+ * 1. Iterative DFS from the root records parent, depth and preorder position.
+ *    Seeing an already visited open cell that is not the parent means the
+ *    maze has a loop, and the build is rejected.
+ * 2. A sparse table over the preorder stores, for every power-of-two range,
+ *    the shallowest cell in it.
+ * Returns: true on success, false if the maze is not a tree or memory runs out.
+ */
+bool build_path_index(PathIndex *idx, const Maze *m, Point root) {
+    static const int dr[4] = {1, 0, -1, 0};
+    static const int dc[4] = {0, 1, 0, -1};
+
+    memset(idx, 0, sizeof(*idx));
+    idx->maze = m;
+    size_t cells = (size_t)m->width * (size_t)m->height;
+    if (cells > INT32_MAX || CELL(m, root.r, root.c) == WALL) {
         return false;
     }
 
-    // Place a marker on the current cell as part of the potential solution
-    maze[r][c] = SOLUTION_PATH;
+    idx->parent = malloc(cells * sizeof(int32_t));
+    idx->depth = malloc(cells * sizeof(int32_t));
+    idx->tin = malloc(cells * sizeof(int32_t));
+    idx->order = malloc(cells * sizeof(int32_t));
+    int32_t *stack = malloc(cells * sizeof(int32_t));
+    if (!idx->parent || !idx->depth || !idx->tin || !idx->order || !stack) {
+        free(stack);
+        free_path_index(idx);
+        return false;
+    }
+    memset(idx->tin, 0xff, cells * sizeof(int32_t)); // All -1: not visited
+
+    // 1. Iterative DFS; a cell gets its preorder position when it is popped
+    bool is_tree = true;
+    size_t top = 0, count = 0;
+    int32_t root_id = (int32_t)((size_t)root.r * (size_t)m->width + (size_t)root.c);
+    idx->parent[root_id] = -1;
+    idx->depth[root_id] = 0;
+    idx->tin[root_id] = INT32_MAX; // Discovered, position assigned on pop
+    stack[top++] = root_id;
+
+    while (top > 0 && is_tree) {
+        int32_t u = stack[--top];
+        idx->tin[u] = (int32_t)count;
+        idx->order[count++] = u;
+
+        int r = u / m->width, c = u % m->width;
+        for (int d = 0; d < 4; d++) {
+            int nr = r + dr[d], nc = c + dc[d];
+            if (nr < 0 || nr >= m->height || nc < 0 || nc >= m->width || CELL(m, nr, nc) == WALL) {
+                continue;
+            }
+            int32_t v = (int32_t)((size_t)nr * (size_t)m->width + (size_t)nc);
+            if (v == idx->parent[u]) {
+                continue;
+            }
+            if (idx->tin[v] != -1) {
+                is_tree = false; // A second route to v: the maze has a loop
+                break;
+            }
+            idx->parent[v] = u;
+            idx->depth[v] = idx->depth[u] + 1;
+            idx->tin[v] = INT32_MAX;
+            stack[top++] = v;
+        }
+    }
+    free(stack);
+    if (!is_tree) {
+        free_path_index(idx);
+        return false;
+    }
+    idx->count = count;
 
-    // Recursively try to solve from all four directions
-    if (solve_maze(r + 1, c)) return true; // Down
-    if (solve_maze(r, c + 1)) return true; // Right
-    if (solve_maze(r - 1, c)) return true; // Up
-    if (solve_maze(r, c - 1)) return true; // Left
+    // 2. Sparse table: row 0 is the preorder itself
+    int levels = 1;
+    while (((size_t)1 << levels) <= count) {
+        levels++;
+    }
+    idx->sparse = calloc((size_t)levels, sizeof(int32_t *));
+    if (!idx->sparse) {
+        free_path_index(idx);
+        return false;
+    }
+    idx->levels = levels;
+    idx->sparse[0] = idx->order;
+    for (int j = 1; j < levels; j++) {
+        size_t half = (size_t)1 << (j - 1);
+        size_t len = count - ((size_t)1 << j) + 1;
+        int32_t *row = malloc(len * sizeof(int32_t));
+        if (!row) {
+            free_path_index(idx);
+            return false;
+        }
+        const int32_t *prev = idx->sparse[j - 1];
+        for (size_t k = 0; k < len; k++) {
+            row[k] = shallower(idx, prev[k], prev[k + half]);
+        }
+        idx->sparse[j] = row;
+    }
+    return true;
+}
 
-    // Backtrack: If no direction led to a solution, this path is a dead end.
-    // Un-mark the cell and return failure.
-    maze[r][c] = PATH;
-    return false;
+/*
+ * Function: cell_id
+ * Purpose: Converts a point to a node id of the index.
+ * Returns: the id, or -1 if the point is outside the maze or not in the tree.
+ */
+int32_t cell_id(const PathIndex *idx, Point p) {
+    const Maze *m = idx->maze;
+    if (p.r < 0 || p.r >= m->height || p.c < 0 || p.c >= m->width) {
+        return -1;
+    }
+    int32_t id = (int32_t)((size_t)p.r * (size_t)m->width + (size_t)p.c);
+    return idx->tin[id] < 0 ? -1 : id;
+}
+
+/*
+ * Function: lca
+ * Purpose: Lowest common ancestor of two tree cells in O(1).
+ * With tin[u] < tin[v], the shallowest cell in preorder range (tin[u], tin[v]]
+ * is a child of the LCA, so its parent is the answer.
+ */
+int32_t lca(const PathIndex *idx, int32_t u, int32_t v) {
+    if (u == v) {
+        return u;
+    }
+    int32_t a = idx->tin[u], b = idx->tin[v];
+    if (a > b) {
+        int32_t t = a; a = b; b = t;
+    }
+    a++;
+    int j = 31 - __builtin_clz((unsigned)(b - a + 1));
+    int32_t x = shallower(idx, idx->sparse[j][a], idx->sparse[j][b - (1 << j) + 1]);
+    return idx->parent[x];
+}
+
+/*
+ * Function: path_distance
+ * Purpose: Number of steps on the unique path between two cells.
+ * Returns: the distance, or -1 if either cell is a wall / unreachable.
+ */
+long path_distance(const PathIndex *idx, Point a, Point b) {
+    int32_t u = cell_id(idx, a), v = cell_id(idx, b);
+    if (u < 0 || v < 0) {
+        return -1;
+    }
+    int32_t w = lca(idx, u, v);
+    return (long)idx->depth[u] + idx->depth[v] - 2L * idx->depth[w];
+}
+
+/*
+ * Function: extract_path
+ * Purpose: Writes the cells of the path from a to b (both included) into out.
+ * out must have room for path_distance(a, b) + 1 points.
+ * Returns: the number of points written, or 0 if there is no path.
+ */
+size_t extract_path(const PathIndex *idx, Point a, Point b, Point *out) {
+    int32_t u = cell_id(idx, a), v = cell_id(idx, b);
+    if (u < 0 || v < 0) {
+        return 0;
+    }
+    int32_t w = lca(idx, u, v);
+    int width = idx->maze->width;
+    size_t up = (size_t)(idx->depth[u] - idx->depth[w]);
+    size_t down = (size_t)(idx->depth[v] - idx->depth[w]);
+
+    // Climb from a to the LCA, then fill the b side backwards
+    size_t k = 0;
+    for (int32_t x = u; x != w; x = idx->parent[x]) {
+        out[k++] = (Point){x / width, x % width};
+    }
+    out[k] = (Point){w / width, w % width};
+    k = up + down;
+    for (int32_t x = v; x != w; x = idx->parent[x]) {
+        out[k--] = (Point){x / width, x % width};
+    }
+    return up + down + 1;
+}
+
+/*
+ * Function: run_query_file
+ * Purpose: Answers a batch of route queries read from a file.
+ * Input: one query per line, "r1 c1 r2 c2".
+ * Output: one line per query with the distance (-1 if there is no path);
+ * with print_paths the cells of the path follow as "r,c" pairs.
+ * Returns: the number of queries answered, QUERY_OPEN_FAILED if the query
+ * file cannot be opened, or QUERY_OUT_OF_MEMORY if a path buffer cannot grow.
+ */
+long run_query_file(const PathIndex *idx, const char *query_file, FILE *out, bool print_paths) {
+    FILE *in = fopen(query_file, "r");
+    if (!in) {
+        return QUERY_OPEN_FAILED;
+    }
+    static char in_buffer[RENDER_BUFFER_SIZE];
+    setvbuf(in, in_buffer, _IOFBF, sizeof(in_buffer));
+
+    Point *path = NULL;
+    size_t path_cap = 0;
+    long answered = 0;
+    Point a, b;
+    while (fscanf(in, "%d %d %d %d", &a.r, &a.c, &b.r, &b.c) == 4) {
+        long dist = path_distance(idx, a, b);
+        fprintf(out, "%ld", dist);
+        if (print_paths && dist >= 0) {
+            if ((size_t)dist + 1 > path_cap) {
+                path_cap = (size_t)dist + 1;
+                Point *grown = realloc(path, path_cap * sizeof(Point));
+                if (!grown) {
+                    fputc('\n', out);
+                    answered = QUERY_OUT_OF_MEMORY;
+                    break;
+                }
+                path = grown;
+            }
+            size_t len = extract_path(idx, a, b, path);
+            fputc(':', out);
+            for (size_t k = 0; k < len; k++) {
+                fprintf(out, " %d,%d", path[k].r, path[k].c);
+            }
+        }
+        fputc('\n', out);
+        answered++;
+    }
+
+    free(path);
+    fclose(in);
+    fflush(out);
+    return answered;
+}
+
+/*
+ * Function: print_usage
+ * Purpose: Describes the command line options.
+ */
+void print_usage(const char *prog) {
+    printf("Usage: %s [seed] [options]\n", prog);
+    printf("  -s <seed>        64-bit seed (default: current time)\n");
+    printf("  -W <width>       maze width, odd (default %d)\n", WIDTH);
+    printf("  -H <height>      maze height, odd (default %d)\n", HEIGHT);
+    printf("  -q               do not print the maze to the console\n");
+    printf("  --text <file>    write the solved maze as text\n");
+    printf("  --pgm <file>     write the solved maze as a PGM image\n");
+    printf("  --pbm <file>     write the maze walls as a PBM bitmap\n");
+    printf("  --save <file>    write the maze as a compact binary dump\n");
+    printf("  --load <file>    load a binary dump instead of generating\n");
+    printf("  --queries <file> answer route queries (lines of \"r1 c1 r2 c2\")\n");
+    printf("  --query-out <file> write query answers to a file (default: console)\n");
+    printf("  --paths          print the cells of each queried path, not just its length\n");
 }
 
 /*
  * Function: main
  * Purpose: Entry point of the program.
  * Orchestrates the maze generation and solving process.
+ * Usage: ./maze [seed] [options]  (see print_usage)
+ * Passing a seed reproduces the same maze; without one the current time is used.
  */
-int main() {
-    // Seed the random number generator to get a different maze each time
-    srand(time(NULL));
+int main(int argc, char *argv[]) {
+    uint64_t seed = (uint64_t)time(NULL);
+    int width = WIDTH, height = HEIGHT;
+    bool quiet = false;
+    const char *text_file = NULL, *pgm_file = NULL, *pbm_file = NULL;
+    const char *save_file = NULL, *load_file = NULL;
+    const char *query_file = NULL, *query_out_file = NULL;
+    bool print_paths = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "-s") == 0 && has_value) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-W") == 0 && has_value) width = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-H") == 0 && has_value) height = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-q") == 0) quiet = true;
+        else if (strcmp(argv[i], "--text") == 0 && has_value) text_file = argv[++i];
+        else if (strcmp(argv[i], "--pgm") == 0 && has_value) pgm_file = argv[++i];
+        else if (strcmp(argv[i], "--pbm") == 0 && has_value) pbm_file = argv[++i];
+        else if (strcmp(argv[i], "--save") == 0 && has_value) save_file = argv[++i];
+        else if (strcmp(argv[i], "--load") == 0 && has_value) load_file = argv[++i];
+        else if (strcmp(argv[i], "--queries") == 0 && has_value) query_file = argv[++i];
+        else if (strcmp(argv[i], "--query-out") == 0 && has_value) query_out_file = argv[++i];
+        else if (strcmp(argv[i], "--paths") == 0) print_paths = true;
+        else if (argv[i][0] >= '0' && argv[i][0] <= '9') seed = strtoull(argv[i], NULL, 0);
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
 
     printf("Random Maze Generator and Solver\n");
-    printf("=================================\n\n");
+    printf("=================================\n");
+
+    Maze maze;
+    if (load_file) {
+        if (!load_maze_binary(&maze, load_file)) {
+            printf("Could not load maze from %s\n", load_file);
+            return 1;
+        }
+        printf("Loaded %d x %d maze from %s\n\n", maze.width, maze.height, load_file);
+    } else {
+        if (!maze_create(&maze, width, height)) {
+            printf("Invalid maze size %d x %d (both must be odd and >= 3).\n", width, height);
+            return 1;
+        }
+        printf("Seed: %llu\n\n", (unsigned long long)seed);
 
-    // 1. Fill the grid with walls
-    initialize_maze();
+        // Seed the generator: explicit seed if given, otherwise a different maze each time
+        Rng rng;
+        rng_seed(&rng, seed);
 
-    // 2. Carve paths to generate the maze, starting from (1,1)
-    generate_maze(1, 1);
+        // 1. Fill the grid with walls
+        initialize_maze(&maze);
 
-    // 3. Define the entrance and exit points
-    maze[1][0] = START;
-    maze[HEIGHT - 2][WIDTH - 1] = END;
+        // 2. Carve paths to generate the maze, starting from (1,1)
+        if (!generate_maze(&maze, 1, 1, &rng)) {
+            printf("Out of memory while generating the maze.\n");
+            maze_free(&maze);
+            return 1;
+        }
 
-    // 4. Print the final generated maze
-    printf("--- Randomly Generated Maze ---\n");
-    print_maze();
+        // 3. Define the entrance and exit points
+        CELL(&maze, maze.start.r, maze.start.c) = START;
+        CELL(&maze, maze.end.r, maze.end.c) = END;
+    }
 
-    // 5. Attempt to solve the maze starting from the entrance
+    // 4. Print / save the final generated maze
+    if (!quiet) {
+        printf("--- Randomly Generated Maze ---\n");
+        print_maze(&maze);
+    }
+    if (save_file) {
+        printf("%s %s\n", save_maze_binary(&maze, save_file) ? "Saved binary dump to" : "Could not write", save_file);
+    }
+    if (pbm_file) {
+        printf("%s %s\n", write_maze_pbm(&maze, pbm_file) ? "Saved PBM image to" : "Could not write", pbm_file);
+    }
+
+    // 5. Answer route queries on the maze tree (before solving marks the path)
+    if (query_file) {
+        PathIndex index;
+        if (!build_path_index(&index, &maze, maze.start)) {
+            printf("Route queries need a perfect (loop-free) maze.\n");
+        } else {
+            static char out_buffer[RENDER_BUFFER_SIZE];
+            FILE *out = query_out_file ? fopen(query_out_file, "w") : stdout;
+            long answered = 0;
+            if (!out) {
+                printf("Could not open query output file %s.\n", query_out_file);
+            } else {
+                if (out != stdout) setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+                answered = run_query_file(&index, query_file, out, print_paths);
+                if (out != stdout) fclose(out);
+                if (answered == QUERY_OPEN_FAILED) {
+                    printf("Could not open query file %s.\n", query_file);
+                } else if (answered == QUERY_OUT_OF_MEMORY) {
+                    printf("Out of memory while answering route queries.\n");
+                } else {
+                    printf("Answered %ld route queries.\n", answered);
+                }
+            }
+            free_path_index(&index);
+            if (answered == QUERY_OUT_OF_MEMORY) {
+                maze_free(&maze);
+                return 1;
+            }
+        }
+    }
+
+    // 6. Attempt to solve the maze starting from the entrance
     printf("Searching for a solution...\n");
-    if (solve_maze(1, 0)) {
+    if (solve_maze(&maze)) {
         // Restore the START character as the solver overwrites it
-        maze[1][0] = START;
-        printf("--- Solved Maze ---\n");
-        print_maze();
+        CELL(&maze, maze.start.r, maze.start.c) = START;
+        if (!quiet) {
+            printf("--- Solved Maze ---\n");
+            print_maze(&maze);
+        }
+        if (text_file) {
+            FILE *out = fopen(text_file, "wb");
+            bool ok = out && write_maze_text(&maze, out);
+            if (out && fclose(out) != 0) ok = false;
+            printf("%s %s\n", ok ? "Saved solved maze to" : "Could not write", text_file);
+        }
+        if (pgm_file) {
+            printf("%s %s\n", write_maze_pgm(&maze, pgm_file) ? "Saved PGM image to" : "Could not write", pgm_file);
+        }
     } else {
         printf("No solution was found for this maze.\n");
     }
 
+    maze_free(&maze);
     return 0;
-}
\ No newline at end of file
+}
@@ -1,80 +1,238 @@
 /*
- * N-Queens Problem Solution for N = 8
+ * N-Queens Problem Solution (N = 8 by default, any N up to 32 at run time)
  * 
  * TIME COMPLEXITY ANALYSIS:
- * - Worst case: O(N^N) - placing queens on each row and checking all columns
+ * - Worst case: O(N!) - placing queens row by row, each row has fewer free columns
+ * - Each placement is checked in O(1) with bitmasks
  * 
  * SPACE COMPLEXITY ANALYSIS:
- * - O(N) for the board array (storing column position for each row)
+ * - O(N) for the column position of each row (only kept while enumerating)
  * - O(N) for recursion stack depth (maximum N recursive calls)
- * - Total: O(N) = O(8) for N=8
+ * - Total: O(N)
  * 
  * ALGORITHM: Backtracking with constraint checking
  * - Place queens row by row
- * - For each row, try placing queen in each column
- * - Check if placement is safe (no conflicts with previous queens)
- * - If safe, recursively solve for next row
- * - If no solution found, backtrack and try next column
+ * - For each row, try placing queen in each free column
+ * - Columns and both diagonals are kept as bitmasks, so the free squares of a
+ *   row are ~(cols | diag1 | diag2) and each candidate is taken with x & -x.
+ *   Checking a placement is O(1) instead of rescanning the earlier rows.
+ * - If no free column is left, backtrack and try next column
+ *
+ * BITBOARD COUNTER (countNQueens):
+ * - Symmetry breaking: only the left half of row 0 is explored and its count
+ *   is doubled (mirror image). For odd N the middle column of row 0 is
+ *   explored with row 1 restricted to its left half, also doubled.
+ *
+ * ENUMERATOR (enumerateNQueens):
+ * - The search does not print anything itself. Each solution is handed to a
+ *   SolutionVisitor callback; the board printer, the buffered stream writer
+ *   and the first-k limit are all built on top of it.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
 
-#define N 8  // Size of the chessboard (8x8)
+#define N 8  // Default size of the chessboard (8x8)
 
-// Global variables
-int board[N];  // board[i] represents the column position of queen in row i
-int solutionCount = 0;  // Counter for total number of solutions found
+#define MAX_BITBOARD_N 32  // Masks are 32-bit
 
 /*
- * Function: isSafe
- * Purpose: Check if placing a queen at position (row, col) is safe
- * Parameters: row - current row, col - current column
- * Returns: true if safe, false if conflicts exist
- * 
- * Checks three types of conflicts:
- * 1. Column conflict: Same column as previous queens
- * 2. Main diagonal conflict: (row1-row2) == (col1-col2)
- * 3. Anti-diagonal conflict: (row1-row2) == (col2-col1)
- */
-bool isSafe(int row, int col) {
-    // Check all previously placed queens (rows 0 to row-1)
-    for (int i = 0; i < row; i++) {
-        // Check column conflict: queens in same column
-        if (board[i] == col) {
-            return false;
+ * Function: countFrom
+ * Purpose: Counts the completions of a partial placement using bitmasks
+ * Parameters: all   - mask with the lowest n bits set (the board width)
+ *             cols  - columns already taken
+ *             diag1 - squares of this row attacked along "\" diagonals
+ *             diag2 - squares of this row attacked along "/" diagonals
+ * Returns: number of ways to fill the remaining rows
+ *
+ * Moving to the next row shifts diag1 left and diag2 right, since a
+ * diagonal moves one column per row.
+ */
+static unsigned long long countFrom(uint32_t all, uint32_t cols, uint32_t diag1, uint32_t diag2) {
+    if (cols == all) {
+        return 1;  // Every column taken: one solution
+    }
+
+    unsigned long long count = 0;
+    uint32_t free = all & ~(cols | diag1 | diag2);
+    while (free) {
+        uint32_t bit = free & -free;  // Lowest free square
+        free ^= bit;
+        count += countFrom(all, cols | bit, (diag1 | bit) << 1, (diag2 | bit) >> 1);
+    }
+    return count;
+}
+
+/*
+ * Function: countNQueens
+ * Purpose: Counts all solutions for an n x n board (1 <= n <= 32)
+ * Returns: the number of solutions
+ *
+ * Uses left/right mirror symmetry: a solution with the row-0 queen in
+ * column c mirrors to one with it in column n-1-c, so only the left half of
+ * row 0 is searched and doubled. For odd n, the middle column of row 0 is
+ * its own mirror; there the row-1 queen (never in the middle) is restricted
+ * to the left half instead.
+ */
+unsigned long long countNQueens(int n) {
+    if (n < 1 || n > MAX_BITBOARD_N) {
+        return 0;
+    }
+    if (n == 1) {
+        return 1;
+    }
+
+    uint32_t all = (n == 32) ? UINT32_MAX : ((1u << n) - 1);
+    uint32_t leftHalf = (1u << (n / 2)) - 1;  // Columns 0 .. n/2-1 (bit i = column i)
+    unsigned long long count = 0;
+
+    // Row 0 in the left half: every solution found has a distinct mirror image
+    for (uint32_t free = leftHalf; free; free &= free - 1) {
+        uint32_t bit = free & -free;
+        count += countFrom(all, bit, bit << 1, bit >> 1);
+    }
+    count *= 2;
+
+    // Odd n: row 0 in the middle column, row 1 restricted to the left half
+    if (n % 2 == 1) {
+        uint32_t mid = 1u << (n / 2);
+        unsigned long long middle = 0;
+        uint32_t free = leftHalf & ~(mid | (mid << 1) | (mid >> 1));
+        while (free) {
+            uint32_t bit = free & -free;
+            free ^= bit;
+            middle += countFrom(all, mid | bit, ((mid << 1) | bit) << 1, ((mid >> 1) | bit) >> 1);
         }
-        
-        // Check diagonal conflicts
-        // Main diagonal: difference in rows equals difference in columns
-        if (abs(board[i] - col) == abs(i - row)) {
-            return false;
+        count += 2 * middle;
+    }
+    return count;
+}
+
+#define STREAM_BUFFER_SIZE (4 << 20)  // Bytes of encoded solutions collected per fwrite
+
+// One character per row in the compact encoding: the queen's column in base 32
+static const char COLUMN_DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+
+/*
+ * Type: SolutionVisitor
+ * Purpose: Receives each solution found by enumerateNQueens
+ * Parameters: cols  - cols[i] is the column of the queen in row i
+ *             n     - board size
+ *             index - 1-based number of this solution
+ *             ctx   - caller data passed through enumerateNQueens
+ * Returns: 0 to continue the search, non-zero to stop it
+ */
+typedef int (*SolutionVisitor)(const int *cols, int n, unsigned long long index, void *ctx);
+
+// State of one enumeration (replaces the old global board / solutionCount)
+typedef struct {
+    int n;
+    uint32_t all;                 // Lowest n bits set
+    int cols[MAX_BITBOARD_N];     // Column of the queen placed in each row
+    unsigned long long found;     // Solutions reported so far
+    unsigned long long limit;     // Stop after this many (0 = no limit)
+    SolutionVisitor visit;
+    void *ctx;
+    bool stopped;
+} Search;
+
+/*
+ * Function: solveNQueens
+ * Purpose: Recursive backtracking over bitmasks that reports every solution
+ * Parameters: s - search state, row - current row being processed,
+ *             cols/diag1/diag2 - attacked squares as in countFrom
+ * 
+ * ALGORITHM STEPS:
+ * 1. Base case: if all rows processed, hand the solution to the visitor
+ * 2. For current row, take each free column (lowest bit first)
+ * 3. Place queen and recursively solve next row
+ * 4. Stop unwinding as soon as the visitor or the limit asks for it
+ */
+static void solveNQueens(Search *s, int row, uint32_t cols, uint32_t diag1, uint32_t diag2) {
+    if (row == s->n) {
+        s->found++;
+        if ((s->visit && s->visit(s->cols, s->n, s->found, s->ctx) != 0) ||
+            (s->limit && s->found >= s->limit)) {
+            s->stopped = true;
         }
+        return;
+    }
+
+    uint32_t free = s->all & ~(cols | diag1 | diag2);
+    while (free && !s->stopped) {
+        uint32_t bit = free & -free;
+        free ^= bit;
+        s->cols[row] = __builtin_ctz(bit);  // Column index of the chosen square
+        solveNQueens(s, row + 1, cols | bit, (diag1 | bit) << 1, (diag2 | bit) >> 1);
+    }
+}
+
+/*
+ * Function: enumerateNQueens
+ * Purpose: Visits the solutions of an n x n board in lexicographic order
+ * Parameters: n     - board size (1 <= n <= 32)
+ *             limit - stop after this many solutions (0 = all of them)
+ *             visit - callback for each solution (may be NULL to just count)
+ *             ctx   - passed to the callback
+ * Returns: number of solutions visited
+ */
+unsigned long long enumerateNQueens(int n, unsigned long long limit, SolutionVisitor visit, void *ctx) {
+    if (n < 1 || n > MAX_BITBOARD_N) {
+        return 0;
     }
-    return true;  // No conflicts found, position is safe
+    Search s = {0};
+    s.n = n;
+    s.all = (n == 32) ? UINT32_MAX : ((1u << n) - 1);
+    s.limit = limit;
+    s.visit = visit;
+    s.ctx = ctx;
+    solveNQueens(&s, 0, 0, 0, 0);
+    return s.found;
+}
+
+/*
+ * Function: printSolution
+ * Purpose: Print the solution in a compact format
+ * Shows the column position of queen in each row
+ */
+void printSolution(const int *cols, int n, unsigned long long index) {
+    printf("Solution %llu: [", index);
+    for (int i = 0; i < n; i++) {
+        printf("%d", cols[i]);
+        if (i < n - 1) printf(", ");
+    }
+    printf("]\n");
 }
 
 /*
  * Function: printBoard
- * Purpose: Display the current solution on the chessboard
+ * Purpose: Display a solution on the chessboard
  * Uses 'Q' for queen positions and '.' for empty squares
  */
-void printBoard() {
-    printf("\nSolution %d:\n", solutionCount);
+void printBoard(const int *cols, int n, unsigned long long index) {
+    printf("\nSolution %llu:\n", index);
     printf("   ");
     
     // Print column headers
-    for (int i = 0; i < N; i++) {
+    for (int i = 0; i < n; i++) {
         printf("%d ", i);
     }
     printf("\n");
     
     // Print each row of the board
-    for (int i = 0; i < N; i++) {
+    for (int i = 0; i < n; i++) {
         printf("%d  ", i);  // Row header
-        for (int j = 0; j < N; j++) {
-            if (board[i] == j) {
+        for (int j = 0; j < n; j++) {
+            if (cols[i] == j) {
                 printf("Q ");  // Queen position
             } else {
                 printf(". ");  // Empty square
@@ -86,85 +244,965 @@ void printBoard() {
 }
 
 /*
- * Function: printSolution
- * Purpose: Print the solution in a compact format
- * Shows the column position of queen in each row
+ * Function: printVisitor
+ * Purpose: SolutionVisitor that prints both the compact and the board format
  */
-void printSolution() {
-    printf("Solution %d: [", solutionCount);
-    for (int i = 0; i < N; i++) {
-        printf("%d", board[i]);
-        if (i < N - 1) printf(", ");
+int printVisitor(const int *cols, int n, unsigned long long index, void *ctx) {
+    (void)ctx;
+    printSolution(cols, n, index);  // Print compact format
+    printBoard(cols, n, index);     // Print visual board
+    return 0;
+}
+
+// Output sink for the streaming mode: solutions are encoded into a large
+// buffer that is written out in blocks
+typedef struct {
+    FILE *out;
+    char *buffer;
+    size_t used, capacity;
+    bool failed;
+} StreamSink;
+
+/*
+ * Function: streamFlush
+ * Purpose: Writes the buffered encodings with a single fwrite
+ */
+void streamFlush(StreamSink *sink) {
+    if (sink->used > 0 && fwrite(sink->buffer, 1, sink->used, sink->out) != sink->used) {
+        sink->failed = true;
     }
-    printf("]\n");
+    sink->used = 0;
 }
 
 /*
- * Function: solveNQueens
- * Purpose: Recursive backtracking function to solve N-Queens
- * Parameters: row - current row being processed
- * Returns: true if solution found, false otherwise
- * 
- * ALGORITHM STEPS:
- * 1. Base case: if all rows processed, solution found
- * 2. For current row, try placing queen in each column
- * 3. Check if placement is safe using isSafe()
- * 4. If safe, place queen and recursively solve next row
- * 5. If recursive call succeeds, continue searching for more solutions
- * 6. Backtrack: remove queen and try next column
- */
-bool solveNQueens(int row) {
-    // Base case: all queens placed successfully
-    if (row >= N) {
-        solutionCount++;
-        printSolution();        // Print compact format
-        printBoard();           // Print visual board
-        return true;
+ * Function: streamVisitor
+ * Purpose: SolutionVisitor that appends "<n column digits>\n" to the sink
+ * Each row is one base-32 character, e.g. "04752613" for the first 8-queens solution.
+ * Returns: non-zero (stop) once a write has failed
+ */
+int streamVisitor(const int *cols, int n, unsigned long long index, void *ctx) {
+    (void)index;
+    StreamSink *sink = ctx;
+    if (sink->used + (size_t)n + 1 > sink->capacity) {
+        streamFlush(sink);
     }
-    
-    // Try placing queen in each column of current row
-    for (int col = 0; col < N; col++) {
-        // Check if placing queen at (row, col) is safe
-        if (isSafe(row, col)) {
-            // Place queen: store column position for this row
-            board[row] = col;
-            
-            // Recursively solve for next row
-            // Note: we continue searching even after finding a solution
-            // to find all possible solutions
-            solveNQueens(row + 1);
-            
-            // Backtrack: this is implicit as we'll overwrite board[row]
-            // in the next iteration or when function returns
+    char *p = sink->buffer + sink->used;
+    for (int i = 0; i < n; i++) {
+        p[i] = COLUMN_DIGITS[cols[i]];
+    }
+    p[n] = '\n';
+    sink->used += (size_t)n + 1;
+    return sink->failed;
+}
+
+/*
+ * Function: streamSolutions
+ * Purpose: Writes the (first limit, or all) solutions to a file in the compact encoding
+ * Returns: number of solutions written, or -1 on I/O error
+ */
+long long streamSolutions(int n, unsigned long long limit, const char *filename) {
+    FILE *out = (strcmp(filename, "-") == 0) ? stdout : fopen(filename, "w");
+    if (!out) {
+        return -1;
+    }
+    StreamSink sink = {out, malloc(STREAM_BUFFER_SIZE), 0, STREAM_BUFFER_SIZE, false};
+    if (!sink.buffer) {
+        if (out != stdout) fclose(out);
+        return -1;
+    }
+
+    unsigned long long found = enumerateNQueens(n, limit, streamVisitor, &sink);
+    streamFlush(&sink);
+    free(sink.buffer);
+    if (out != stdout) {
+        if (fclose(out) != 0) sink.failed = true;
+    } else {
+        fflush(out);
+    }
+    return sink.failed ? -1 : (long long)found;
+}
+
+#define DEFAULT_SPLIT_DEPTH 3  // Rows fixed before a subproblem is solved sequentially
+
+// A partial placement: rows 0 .. row-1 are filled
+typedef struct {
+    int row;
+    uint32_t cols, diag1, diag2;
+    unsigned weight;  // 2 if the subproblem also stands for its mirror image
+} Subproblem;
+
+// Work-stealing deque: the owner pushes/pops at the tail, thieves take from the head
+typedef struct {
+    pthread_mutex_t lock;
+    Subproblem *items;
+    size_t head, tail, capacity;  // Live items are items[head .. tail)
+} TaskDeque;
+
+typedef struct WorkerPool WorkerPool;
+
+typedef struct {
+    WorkerPool *pool;
+    int id;
+    TaskDeque deque;
+    unsigned long long count;  // Solutions found by this worker
+    pthread_t thread;
+} Worker;
+
+struct WorkerPool {
+    uint32_t all;
+    int splitDepth;
+    int threads;
+    Worker *workers;
+    atomic_size_t pending;  // Subproblems pushed but not finished yet
+};
+
+/*
+ * Function: dequePush
+ * Purpose: Adds a subproblem at the tail of a deque, growing it if needed
+ * Returns: false if memory runs out
+ */
+static bool dequePush(TaskDeque *dq, Subproblem task) {
+    bool ok = true;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail == dq->capacity) {
+        if (dq->head > 0) {
+            // Reuse the space freed by thieves before growing
+            memmove(dq->items, dq->items + dq->head, (dq->tail - dq->head) * sizeof(Subproblem));
+            dq->tail -= dq->head;
+            dq->head = 0;
+        } else {
+            size_t capacity = dq->capacity ? dq->capacity * 2 : 64;
+            Subproblem *items = realloc(dq->items, capacity * sizeof(Subproblem));
+            if (items) {
+                dq->items = items;
+                dq->capacity = capacity;
+            } else {
+                ok = false;
+            }
         }
     }
-    
+    if (ok) {
+        dq->items[dq->tail++] = task;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return ok;
+}
+
+/*
+ * Function: dequePop
+ * Purpose: Owner side: takes the newest subproblem (depth-first order)
+ */
+static bool dequePop(TaskDeque *dq, Subproblem *task) {
+    bool ok = false;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail > dq->head) {
+        *task = dq->items[--dq->tail];
+        ok = true;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return ok;
+}
+
+/*
+ * Function: dequeSteal
+ * Purpose: Thief side: takes the oldest subproblem (closest to the root)
+ */
+static bool dequeSteal(TaskDeque *dq, Subproblem *task) {
+    bool ok = false;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail > dq->head) {
+        *task = dq->items[dq->head++];
+        ok = true;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return ok;
+}
+
+/*
+ * Function: runSubproblem
+ * Purpose: Expands a shallow subproblem into its children (pushed on the
+ * worker's own deque, where others can steal them) or counts a deep one
+ * sequentially
+ */
+static void runSubproblem(Worker *self, const Subproblem *task) {
+    WorkerPool *pool = self->pool;
+    if (task->row >= pool->splitDepth) {
+        self->count += task->weight * countFrom(pool->all, task->cols, task->diag1, task->diag2);
+        return;
+    }
+    if (task->cols == pool->all) {
+        self->count += task->weight;  // Board smaller than the split depth
+        return;
+    }
+
+    uint32_t free = pool->all & ~(task->cols | task->diag1 | task->diag2);
+    while (free) {
+        uint32_t bit = free & -free;
+        free ^= bit;
+        Subproblem child = {task->row + 1, task->cols | bit, (task->diag1 | bit) << 1,
+                            (task->diag2 | bit) >> 1, task->weight};
+        atomic_fetch_add(&pool->pending, 1);
+        if (!dequePush(&self->deque, child)) {
+            runSubproblem(self, &child);  // Out of memory: do it right here
+            atomic_fetch_sub(&pool->pending, 1);
+        }
+    }
+}
+
+/*
+ * Function: workerMain
+ * Purpose: Thread body: drain the own deque, then steal, until no subproblem is pending
+ */
+static void *workerMain(void *arg) {
+    Worker *self = arg;
+    WorkerPool *pool = self->pool;
+    Subproblem task;
+
+    for (;;) {
+        bool got = dequePop(&self->deque, &task);
+        for (int k = 1; !got && k < pool->threads; k++) {
+            got = dequeSteal(&pool->workers[(self->id + k) % pool->threads].deque, &task);
+        }
+        if (!got) {
+            if (atomic_load(&pool->pending) == 0) {
+                break;  // Nothing queued anywhere and nobody is expanding
+            }
+            sched_yield();
+            continue;
+        }
+        runSubproblem(self, &task);
+        atomic_fetch_sub(&pool->pending, 1);
+    }
+    return NULL;
+}
+
+/*
+ * Function: countNQueensParallel
+ * Purpose: Counts all solutions for an n x n board with a work-stealing thread pool
+ * Parameters: n          - board size (1 <= n <= 32)
+ *             threads    - number of worker threads
+ *             splitDepth - rows fixed before a subproblem is solved sequentially
+ * Returns: the number of solutions (same as countNQueens)
+ *
+ * The root subproblems use the same mirror symmetry as countNQueens and are
+ * dealt round-robin to the workers; everything after that is balanced by stealing.
+ */
+unsigned long long countNQueensParallel(int n, int threads, int splitDepth) {
+    if (n < 1 || n > MAX_BITBOARD_N) {
+        return 0;
+    }
+    if (n == 1) {
+        return 1;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    WorkerPool pool;
+    pool.all = (n == 32) ? UINT32_MAX : ((1u << n) - 1);
+    pool.splitDepth = splitDepth;
+    pool.threads = threads;
+    atomic_init(&pool.pending, 0);
+    pool.workers = calloc((size_t)threads, sizeof(Worker));
+    if (!pool.workers) {
+        return countNQueens(n);
+    }
+    for (int t = 0; t < threads; t++) {
+        pool.workers[t].pool = &pool;
+        pool.workers[t].id = t;
+        pthread_mutex_init(&pool.workers[t].deque.lock, NULL);
+    }
+
+    // Root subproblems: left half of row 0, plus the middle column for odd n
+    uint32_t leftHalf = (1u << (n / 2)) - 1;
+    int next = 0;
+    for (uint32_t free = leftHalf; free; free &= free - 1) {
+        uint32_t bit = free & -free;
+        Subproblem root = {1, bit, bit << 1, bit >> 1, 2};
+        atomic_fetch_add(&pool.pending, 1);
+        if (!dequePush(&pool.workers[next++ % threads].deque, root)) {
+            runSubproblem(&pool.workers[0], &root);
+            atomic_fetch_sub(&pool.pending, 1);
+        }
+    }
+    if (n % 2 == 1) {
+        uint32_t mid = 1u << (n / 2);
+        uint32_t free = leftHalf & ~(mid | (mid << 1) | (mid >> 1));
+        for (; free; free &= free - 1) {
+            uint32_t bit = free & -free;
+            Subproblem root = {2, mid | bit, ((mid << 1) | bit) << 1, ((mid >> 1) | bit) >> 1, 2};
+            atomic_fetch_add(&pool.pending, 1);
+            if (!dequePush(&pool.workers[next++ % threads].deque, root)) {
+                runSubproblem(&pool.workers[0], &root);
+                atomic_fetch_sub(&pool.pending, 1);
+            }
+        }
+    }
+
+    // Worker 0 runs on the calling thread
+    int started = 1;
+    for (int t = 1; t < threads; t++, started++) {
+        if (pthread_create(&pool.workers[t].thread, NULL, workerMain, &pool.workers[t]) != 0) {
+            break;  // Fewer threads: the remaining deques are stolen from
+        }
+    }
+    workerMain(&pool.workers[0]);
+
+    unsigned long long count = pool.workers[0].count;
+    for (int t = 1; t < started; t++) {
+        pthread_join(pool.workers[t].thread, NULL);
+        count += pool.workers[t].count;
+    }
+    // Deques of threads that failed to start were drained by the others
+    for (int t = started; t < threads; t++) {
+        count += pool.workers[t].count;
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_mutex_destroy(&pool.workers[t].deque.lock);
+        free(pool.workers[t].deque.items);
+    }
+    free(pool.workers);
+    return count;
+}
+
+#define CHECKPOINT_INTERVAL 60  // Default seconds between checkpoints of a shard
+
+// Growable list of prefixes
+typedef struct {
+    Subproblem *items;
+    size_t count, capacity;
+} PrefixList;
+
+static bool prefixAppend(PrefixList *list, Subproblem item) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 256;
+        Subproblem *items = realloc(list->items, capacity * sizeof(Subproblem));
+        if (!items) {
+            return false;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = item;
+    return true;
+}
+
+/*
+ * Function: expandPrefix
+ * Purpose: Depth-first expansion of a partial placement down to `depth` rows
+ * Returns: false if memory runs out
+ */
+static bool expandPrefix(PrefixList *list, uint32_t all, int depth, Subproblem p) {
+    if (p.row >= depth || p.cols == all) {
+        return prefixAppend(list, p);
+    }
+    uint32_t free = all & ~(p.cols | p.diag1 | p.diag2);
+    for (; free; free &= free - 1) {
+        uint32_t bit = free & -free;
+        Subproblem child = {p.row + 1, p.cols | bit, (p.diag1 | bit) << 1, (p.diag2 | bit) >> 1, p.weight};
+        if (!expandPrefix(list, all, depth, child)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Function: listPrefixes
+ * Purpose: Lists the symmetric prefixes of an n x n board with `depth` rows fixed
+ * The order depends only on n and depth, so every process sees the same indices.
+ * Summing weight * countFrom(prefix) over the list gives countNQueens(n) (n >= 2).
+ * Returns: false if memory runs out
+ */
+bool listPrefixes(int n, int depth, PrefixList *list) {
+    uint32_t all = (n == 32) ? UINT32_MAX : ((1u << n) - 1);
+    uint32_t leftHalf = (1u << (n / 2)) - 1;
+    list->items = NULL;
+    list->count = list->capacity = 0;
+
+    for (uint32_t free = leftHalf; free; free &= free - 1) {
+        uint32_t bit = free & -free;
+        if (!expandPrefix(list, all, depth, (Subproblem){1, bit, bit << 1, bit >> 1, 2})) {
+            return false;
+        }
+    }
+    if (n % 2 == 1) {
+        uint32_t mid = 1u << (n / 2);
+        uint32_t free = leftHalf & ~(mid | (mid << 1) | (mid >> 1));
+        for (; free; free &= free - 1) {
+            uint32_t bit = free & -free;
+            Subproblem p = {2, mid | bit, ((mid << 1) | bit) << 1, ((mid >> 1) | bit) >> 1, 2};
+            if (!expandPrefix(list, all, depth, p)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Progress of one shard, as saved on disk
+typedef struct {
+    int n, depth;
+    int shard, shards;          // This is shard `shard` of `shards`
+    unsigned long long prefixes; // Total prefixes of the run (consistency check)
+    unsigned long long next;    // First prefix index not processed yet
+    unsigned long long count;   // Solutions in the prefixes before `next`
+    int done;
+} Checkpoint;
+
+/*
+ * Function: writeCheckpoint
+ * Purpose: Saves a checkpoint atomically (temporary file, then rename), so a
+ * crash while writing leaves the previous checkpoint intact
+ * Returns: true on success
+ */
+bool writeCheckpoint(const char *filename, const Checkpoint *ck) {
+    char tmp[4096];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", filename) >= (int)sizeof(tmp)) {
+        return false;
+    }
+    FILE *out = fopen(tmp, "w");
+    if (!out) {
+        return false;
+    }
+    fprintf(out, "nqueens-checkpoint 1\n");
+    fprintf(out, "n %d\ndepth %d\nshard %d %d\n", ck->n, ck->depth, ck->shard, ck->shards);
+    fprintf(out, "prefixes %llu\nnext %llu\ncount %llu\ndone %d\n", ck->prefixes, ck->next, ck->count, ck->done);
+    bool ok = fflush(out) == 0 && fsync(fileno(out)) == 0;
+    ok = (fclose(out) == 0) && ok;
+    return ok && rename(tmp, filename) == 0;
+}
+
+/*
+ * Function: readCheckpoint
+ * Purpose: Loads a checkpoint written by writeCheckpoint
+ * Returns: true if the file exists and is well formed
+ */
+bool readCheckpoint(const char *filename, Checkpoint *ck) {
+    FILE *in = fopen(filename, "r");
+    if (!in) {
+        return false;
+    }
+    int version = 0;
+    int fields = fscanf(in, "nqueens-checkpoint %d n %d depth %d shard %d %d prefixes %llu next %llu count %llu done %d",
+                        &version, &ck->n, &ck->depth, &ck->shard, &ck->shards,
+                        &ck->prefixes, &ck->next, &ck->count, &ck->done);
+    fclose(in);
+    return fields == 9 && version == 1;
+}
+
+/*
+ * Function: runShard
+ * Purpose: Counts the solutions in shard `shard` of `shards`, resuming from
+ * and periodically updating the checkpoint file
+ * Parameters: interval - seconds between checkpoints
+ * Returns: 0 on success, 1 on error
+ */
+int runShard(int n, int shard, int shards, const char *filename, int interval) {
+    if (shards < 1 || shard < 0 || shard >= shards) {
+        printf("Invalid shard %d/%d\n", shard, shards);
+        return 1;
+    }
+    PrefixList list;
+    if (!listPrefixes(n, DEFAULT_SPLIT_DEPTH, &list)) {
+        free(list.items);
+        printf("Out of memory while listing prefixes.\n");
+        return 1;
+    }
+
+    Checkpoint ck = {n, DEFAULT_SPLIT_DEPTH, shard, shards, list.count, (unsigned long long)shard, 0, 0};
+    Checkpoint saved;
+    errno = 0;
+    if (readCheckpoint(filename, &saved)) {
+        if (saved.n != ck.n || saved.depth != ck.depth || saved.shard != ck.shard ||
+            saved.shards != ck.shards || saved.prefixes != ck.prefixes) {
+            printf("Checkpoint %s belongs to a different run.\n", filename);
+            free(list.items);
+            return 1;
+        }
+        ck = saved;
+        printf("Resuming shard %d/%d from prefix %llu (%llu solutions so far)\n",
+               shard, shards, ck.next, ck.count);
+    } else if (errno != ENOENT) {
+        printf("Could not read checkpoint %s\n", filename);
+        free(list.items);
+        return 1;
+    }
+
+    uint32_t all = (n == 32) ? UINT32_MAX : ((1u << n) - 1);
+    time_t lastSave = time(NULL);
+    while (!ck.done) {
+        if (ck.next >= list.count) {
+            ck.done = 1;
+        } else {
+            const Subproblem *p = &list.items[ck.next];
+            ck.count += p->weight * countFrom(all, p->cols, p->diag1, p->diag2);
+            ck.next += (unsigned long long)shards;
+        }
+        if (ck.done || time(NULL) - lastSave >= interval) {
+            if (!writeCheckpoint(filename, &ck)) {
+                printf("Could not write checkpoint %s\n", filename);
+                free(list.items);
+                return 1;
+            }
+            lastSave = time(NULL);
+        }
+    }
+    free(list.items);
+
+    printf("Shard %d/%d of N = %d: %llu solutions (checkpoint %s)\n", shard, shards, n, ck.count, filename);
+    return 0;
+}
+
+/*
+ * Function: mergeShards
+ * Purpose: Adds up the counts of finished shard checkpoints
+ * Every file must come from the same run, be finished, and each shard
+ * 0 .. k-1 must appear exactly once.
+ * Returns: 0 on success, 1 if the shards are incomplete or inconsistent
+ */
+int mergeShards(int files, char **filenames) {
+    if (files < 1) {
+        printf("No checkpoint files to merge.\n");
+        return 1;
+    }
+    Checkpoint first, ck;
+    bool *seen = NULL;
+    unsigned long long total = 0;
+    int status = 0;
+
+    for (int f = 0; f < files && status == 0; f++) {
+        if (!readCheckpoint(filenames[f], &ck)) {
+            printf("Could not read checkpoint %s\n", filenames[f]);
+            status = 1;
+            break;
+        }
+        if (f == 0) {
+            first = ck;
+            seen = (ck.shards > 0) ? calloc((size_t)ck.shards, sizeof(bool)) : NULL;
+            if (!seen) {
+                status = 1;
+                break;
+            }
+        }
+        if (ck.n != first.n || ck.depth != first.depth || ck.shards != first.shards ||
+            ck.prefixes != first.prefixes || ck.shard < 0 || ck.shard >= first.shards) {
+            printf("%s belongs to a different run.\n", filenames[f]);
+            status = 1;
+        } else if (!ck.done) {
+            printf("Shard %d (%s) is not finished yet.\n", ck.shard, filenames[f]);
+            status = 1;
+        } else if (seen[ck.shard]) {
+            printf("Shard %d appears twice.\n", ck.shard);
+            status = 1;
+        } else {
+            seen[ck.shard] = true;
+            total += ck.count;
+        }
+    }
+    for (int s = 0; status == 0 && s < first.shards; s++) {
+        if (!seen[s]) {
+            printf("Shard %d/%d is missing.\n", s, first.shards);
+            status = 1;
+        }
+    }
+    free(seen);
+
+    if (status == 0) {
+        printf("Total solutions for N = %d: %llu (%d shards)\n", first.n, total, first.shards);
+    }
+    return status;
+}
+
+// --- One Solution for Huge N ---
+
+/*
+ * Function: constructNQueens
+ * Purpose: Builds one solution directly, in O(n)
+ * Parameters: n - board size, cols - output, cols[i] = column of the queen in row i
+ * Returns: false for n = 2 and n = 3 (no solution exists)
+ *
+ * With 1-based columns, list the even numbers 2, 4, ... then the odd
+ * numbers 1, 3, ...; row i takes the i-th number. This works unless:
+ * - n mod 6 == 2: swap 1 and 3 among the odds and move 5 to the end
+ * - n mod 6 == 3: move 2 to the end of the evens and 1, 3 to the end of the odds
+ */
+bool constructNQueens(int n, int32_t *cols) {
+    if (n == 2 || n == 3) {
+        return false;
+    }
+    int k = 0;
+    int rem = n % 6;
+
+    // Even columns (1-based 2, 4, ...)
+    int evenStart = (rem == 3) ? 4 : 2;
+    for (int v = evenStart; v <= n; v += 2) cols[k++] = v - 1;
+    if (rem == 3) cols[k++] = 2 - 1;
+
+    // Odd columns (1-based 1, 3, ...)
+    if (rem == 2) {
+        cols[k++] = 3 - 1;
+        cols[k++] = 1 - 1;
+        for (int v = 7; v <= n; v += 2) cols[k++] = v - 1;
+        if (n >= 5) cols[k++] = 5 - 1;
+    } else if (rem == 3) {
+        for (int v = 5; v <= n; v += 2) cols[k++] = v - 1;
+        cols[k++] = 1 - 1;
+        cols[k++] = 3 - 1;
+    } else {
+        for (int v = 1; v <= n; v += 2) cols[k++] = v - 1;
+    }
+    return true;
+}
+
+/*
+ * Function: validateNQueens
+ * Purpose: Checks a placement in O(n): every column in range, and no column
+ * or diagonal used twice
+ * Returns: true if the placement is a solution
+ */
+bool validateNQueens(int n, const int32_t *cols) {
+    unsigned char *usedCol = calloc((size_t)n, 1);
+    unsigned char *usedDiag1 = calloc(2 * (size_t)n, 1);
+    unsigned char *usedDiag2 = calloc(2 * (size_t)n, 1);
+    bool valid = usedCol && usedDiag1 && usedDiag2;
+
+    for (int r = 0; r < n && valid; r++) {
+        int c = cols[r];
+        if (c < 0 || c >= n || usedCol[c] || usedDiag1[r + c] || usedDiag2[r - c + n - 1]) {
+            valid = false;
+        } else {
+            usedCol[c] = usedDiag1[r + c] = usedDiag2[r - c + n - 1] = 1;
+        }
+    }
+
+    free(usedCol);
+    free(usedDiag1);
+    free(usedDiag2);
+    return valid;
+}
+
+// splitmix64: small seeded generator for the local search
+static uint64_t nextRandom(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform integer in [0, bound) (multiply-shift, bias below 2^-32 for bound < 2^32)
+static uint32_t randomBelow(uint64_t *state, uint32_t bound) {
+    return (uint32_t)(((nextRandom(state) >> 32) * (uint64_t)bound) >> 32);
+}
+
+// Queens on each "\" (r + c) and "/" (r - c + n - 1) diagonal of the local search
+typedef struct {
+    int n;
+    int32_t *cols;
+    uint32_t *diag1, *diag2;
+    long long collisions;  // Sum over diagonals of (queens - 1) where occupied
+} ConflictBoard;
+
+// Adds (delta = +1) or removes (delta = -1) the queen of row r, updating collisions in O(1)
+static inline void moveQueen(ConflictBoard *b, int r, int delta) {
+    uint32_t *d1 = &b->diag1[r + b->cols[r]];
+    uint32_t *d2 = &b->diag2[r - b->cols[r] + b->n - 1];
+    if (delta > 0) {
+        b->collisions += (*d1 > 0) + (*d2 > 0);
+        (*d1)++;
+        (*d2)++;
+    } else {
+        (*d1)--;
+        (*d2)--;
+        b->collisions -= (*d1 > 0) + (*d2 > 0);
+    }
+}
+
+static inline bool isAttacked(const ConflictBoard *b, int r) {
+    return b->diag1[r + b->cols[r]] > 1 || b->diag2[r - b->cols[r] + b->n - 1] > 1;
+}
+
+/*
+ * Function: trySwap
+ * Purpose: Swaps the columns of rows i and j if that lowers the collisions
+ * Returns: true if the swap was kept
+ */
+static bool trySwap(ConflictBoard *b, int i, int j) {
+    long long before = b->collisions;
+    moveQueen(b, i, -1);
+    moveQueen(b, j, -1);
+    int32_t t = b->cols[i]; b->cols[i] = b->cols[j]; b->cols[j] = t;
+    moveQueen(b, i, +1);
+    moveQueen(b, j, +1);
+    if (b->collisions < before) {
+        return true;
+    }
+    // Undo
+    moveQueen(b, i, -1);
+    moveQueen(b, j, -1);
+    t = b->cols[i]; b->cols[i] = b->cols[j]; b->cols[j] = t;
+    moveQueen(b, i, +1);
+    moveQueen(b, j, +1);
     return false;
 }
 
+/*
+ * Function: swapRepairNQueens
+ * Purpose: Finds one solution for large n by local search (n >= 4)
+ * Parameters: n - board size, cols - output placement, seed - random seed,
+ *             steps - if not NULL, receives the number of repair swaps tried
+ * Returns: true when a solution was found
+ *
+ * ALGORITHM STEPS:
+ * 1. Greedy start: row by row, swap in random remaining columns until one
+ *    has free diagonals (bounded number of tries); the last rows are left random
+ * 2. Collect the rows whose queen is attacked
+ * 3. For each, swap with random rows until a swap lowers the collisions
+ * 4. Repeat 2-3 until no collisions are left; restart if it stalls
+ *
+ * NOTE: this is the swap-based repair of Sosic and Gu, not the classic
+ * min-conflicts heuristic (move an attacked queen to the least attacked
+ * square of its line). That move has to score all n squares, O(n) per step,
+ * while a swap is scored in O(1) from the diagonal counters and keeps the
+ * columns a permutation.
+ */
+bool swapRepairNQueens(int n, int32_t *cols, uint64_t seed, unsigned long long *steps) {
+    if (n < 4) {
+        return n == 1 ? (cols[0] = 0, true) : false;
+    }
+    ConflictBoard b = {n, cols, calloc(2 * (size_t)n, sizeof(uint32_t)), calloc(2 * (size_t)n, sizeof(uint32_t)), 0};
+    int32_t *attacked = malloc((size_t)n * sizeof(int32_t));
+    if (!b.diag1 || !b.diag2 || !attacked) {
+        free(b.diag1);
+        free(b.diag2);
+        free(attacked);
+        return false;
+    }
+
+    uint64_t rng = seed;
+    unsigned long long tried = 0;
+    bool solved = false;
+    int randomTail = n < 100 ? n / 2 : 50;  // Rows left to the repair phase
+
+    for (int attempt = 0; attempt < 100 && !solved; attempt++) {
+        memset(b.diag1, 0, 2 * (size_t)n * sizeof(uint32_t));
+        memset(b.diag2, 0, 2 * (size_t)n * sizeof(uint32_t));
+        b.collisions = 0;
+        for (int r = 0; r < n; r++) cols[r] = r;
+
+        // 1. Greedy start on a random permutation
+        for (int r = 0; r < n; r++) {
+            int tries = (r < n - randomTail) ? 64 : 1;
+            for (int t = 0; t < tries; t++) {
+                int j = r + (int)randomBelow(&rng, (uint32_t)(n - r));
+                int32_t tmp = cols[r]; cols[r] = cols[j]; cols[j] = tmp;
+                if (b.diag1[r + cols[r]] == 0 && b.diag2[r - cols[r] + n - 1] == 0) {
+                    break;
+                }
+            }
+            moveQueen(&b, r, +1);
+        }
+
+        // 2-4. Repair passes
+        long long maxSwaps = 20LL * n + 10000;
+        long long swaps = 0;
+        while (b.collisions > 0 && swaps < maxSwaps) {
+            int count = 0;
+            for (int r = 0; r < n; r++) {
+                if (isAttacked(&b, r)) attacked[count++] = r;
+            }
+            for (int k = 0; k < count && b.collisions > 0; k++) {
+                int i = attacked[k];
+                for (int t = 0; t < 1000 && isAttacked(&b, i); t++, swaps++) {
+                    int j = (int)randomBelow(&rng, (uint32_t)n);
+                    if (j != i && trySwap(&b, i, j)) {
+                        break;
+                    }
+                }
+            }
+        }
+        tried += (unsigned long long)swaps;
+        solved = (b.collisions == 0);
+    }
+
+    free(b.diag1);
+    free(b.diag2);
+    free(attacked);
+    if (steps) {
+        *steps = tried;
+    }
+    return solved;
+}
+
+/*
+ * Function: savePlacement
+ * Purpose: Writes a placement as one column index per line (row order)
+ * Returns: true on success
+ */
+bool savePlacement(int n, const int32_t *cols, const char *filename) {
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        return false;
+    }
+    static char buffer[STREAM_BUFFER_SIZE];
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+    for (int r = 0; r < n; r++) {
+        fprintf(out, "%d\n", cols[r]);
+    }
+    return fclose(out) == 0;
+}
+
+/*
+ * Function: printUsage
+ * Purpose: Describes the command line options
+ */
+void printUsage(const char *prog) {
+    printf("Usage: %s [n] [mode]\n", prog);
+    printf("  (no arguments)     print all solutions for N = %d\n", N);
+    printf("  n                  count the solutions (no output per solution)\n");
+    printf("  n --threads <t>    count with t work-stealing threads (default: all cores)\n");
+    printf("  n --shard i/k      count only shard i of k, with checkpoints and resume\n");
+    printf("     [--checkpoint <file>] [--interval <seconds>]\n");
+    printf("  --merge <files...> add up the finished shard checkpoints\n");
+    printf("  n --construct      one solution for any n (closed form, O(n))\n");
+    printf("  n --local-search   one solution for any n by swap repair [--seed <s>]\n");
+    printf("     [--save <file>] write that solution, one column per line\n");
+    printf("  n --print          print every solution as a board\n");
+    printf("  n --stream <file>  write one compact line per solution ('-' = stdout)\n");
+    printf("  n --first <k>      stop after the first k solutions (with --print or --stream,\n");
+    printf("                     otherwise prints them)\n");
+}
+
 /*
  * Function: main
  * Purpose: Entry point of the program
- * Initializes the board and starts the solving process
+ * Parses the mode and starts the solving process
  */
-int main() {
-    printf("N-Queens Problem Solution for N = %d\n", N);
-    printf("=======================================\n\n");
-    
-    // Initialize board array (optional, as we overwrite values anyway)
-    for (int i = 0; i < N; i++) {
-        board[i] = -1;
+int main(int argc, char *argv[]) {
+    int n = N;
+    bool print = (argc == 1);  // Without arguments keep the classic 8-queens printout
+    const char *streamFile = NULL;
+    unsigned long long first = 0;
+    long onlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = onlineCores > 0 ? (int)onlineCores : 1;
+    int shard = -1, shards = 0, interval = CHECKPOINT_INTERVAL;
+    const char *checkpointFile = NULL;
+    bool construct = false, localSearch = false;
+    uint64_t seed = (uint64_t)time(NULL);
+    const char *saveFile = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--print") == 0) print = true;
+        else if (strcmp(argv[i], "--stream") == 0 && hasValue) streamFile = argv[++i];
+        else if (strcmp(argv[i], "--first") == 0 && hasValue) first = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--shard") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%d/%d", &shard, &shards) != 2) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--checkpoint") == 0 && hasValue) checkpointFile = argv[++i];
+        else if (strcmp(argv[i], "--interval") == 0 && hasValue) interval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--merge") == 0) return mergeShards(argc - i - 1, argv + i + 1);
+        else if (strcmp(argv[i], "--construct") == 0) construct = true;
+        else if (strcmp(argv[i], "--local-search") == 0) localSearch = true;
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) seed = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--save") == 0 && hasValue) saveFile = argv[++i];
+        else if (argv[i][0] >= '0' && argv[i][0] <= '9') n = atoi(argv[i]);
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
     }
+
+    // Single-solution modes for huge N: construct or search, then validate in O(n)
+    if (construct || localSearch) {
+        if (n < 1) {
+            printf("N must be at least 1\n");
+            return 1;
+        }
+        int32_t *cols = malloc((size_t)n * sizeof(int32_t));
+        if (!cols) {
+            printf("Out of memory for N = %d\n", n);
+            return 1;
+        }
+        unsigned long long steps = 0;
+        bool found = construct ? constructNQueens(n, cols) : swapRepairNQueens(n, cols, seed, &steps);
+        if (!found) {
+            printf("No solution found for N = %d\n", n);
+            free(cols);
+            return 1;
+        }
+        bool valid = validateNQueens(n, cols);
+        printf("%s solution for N = %d: %s\n", construct ? "Constructed" : "Local search (swap repair)",
+               n, valid ? "valid" : "INVALID");
+        if (localSearch) {
+            printf("Seed %llu, %llu repair swaps\n", (unsigned long long)seed, steps);
+        }
+        if (saveFile) {
+            printf("%s %s\n", savePlacement(n, cols, saveFile) ? "Saved placement to" : "Could not write", saveFile);
+        } else if (n <= MAX_BITBOARD_N) {
+            printSolution(cols, n, 1);
+        }
+        free(cols);
+        return valid ? 0 : 1;
+    }
+
+    if (n < 1 || n > MAX_BITBOARD_N) {
+        printf("N must be between 1 and %d\n", MAX_BITBOARD_N);
+        return 1;
+    }
+    if (first && !streamFile) {
+        print = true;
+    }
+
+    // Sharded mode: one slice of the prefixes, checkpointed to a file
+    if (shards > 0) {
+        char defaultFile[64];
+        if (!checkpointFile) {
+            snprintf(defaultFile, sizeof(defaultFile), "nqueens-%d-shard-%d-of-%d.ckpt", n, shard, shards);
+            checkpointFile = defaultFile;
+        }
+        if (n < 2) {
+            printf("Sharding needs N >= 2\n");
+            return 1;
+        }
+        return runShard(n, shard, shards, checkpointFile, interval);
+    }
+
+    // Streaming mode: compact encodings only, nothing else on stdout if it is the target
+    if (streamFile) {
+        long long written = streamSolutions(n, first, streamFile);
+        if (written < 0) {
+            fprintf(stderr, "Error writing %s\n", streamFile);
+            return 1;
+        }
+        if (strcmp(streamFile, "-") != 0) {
+            printf("Wrote %lld solutions for N = %d to %s\n", written, n, streamFile);
+        }
+        return 0;
+    }
+
+    // Count-only mode: symmetric bitboard counter, no output per solution
+    if (!print) {
+        unsigned long long total = (threads > 1) ? countNQueensParallel(n, threads, DEFAULT_SPLIT_DEPTH)
+                                                 : countNQueens(n);
+        printf("Total solutions for N = %d: %llu\n", n, total);
+        return 0;
+    }
+
+    printf("N-Queens Problem Solution for N = %d\n", n);
+    printf("=======================================\n\n");
+    printf("Searching for %s...\n", first ? "the first solutions" : "all possible solutions");
     
-    printf("Searching for all possible solutions...\n");
-    
-    // Start solving from row 0
-    solveNQueens(0);
+    unsigned long long solutionCount = enumerateNQueens(n, first, printVisitor, NULL);
     
     // Print final statistics
     printf("\n=======================================\n");
-    printf("Total solutions found: %d\n", solutionCount);
-    printf("Board size: %d x %d\n", N, N);
+    printf("Total solutions found: %llu\n", solutionCount);
+    printf("Board size: %d x %d\n", n, n);
     
     return 0;
 }
@@ -172,9 +1210,9 @@ int main() {
 /*
  * ADDITIONAL NOTES:
  * 
- * 1. OPTIMIZATION OPPORTUNITIES:
- *    - Use bit manipulation for faster conflict checking
- *    - Implement symmetry breaking to reduce redundant calculations
+ * 1. OPTIMIZATIONS:
+ *    - Bit manipulation for faster conflict checking
+ *    - Mirror-symmetry breaking halves the search (countNQueens)
  *    - Use iterative deepening for memory efficiency
  * 
  * 2. PROBLEM CHARACTERISTICS:
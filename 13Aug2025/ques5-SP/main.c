@@ -1,51 +1,844 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
 
-// Function to calculate nth Catalan number
-long long catalan(int n) {
-    if (n <= 1) {
+typedef unsigned __int128 u128;
+
+#define KARATSUBA_THRESHOLD 32   // Below this many limbs, schoolbook multiplication is faster
+#define TABLE_MAX_N 80           // Upper bound for the 128-bit lookup table (C(69) is the last that fits)
+
+// ------------------------------------------------------------
+// O(n) multiplicative recurrence with overflow detection
+//
+//   C(0) = 1,  C(k+1) = C(k) * 2(2k+1) / (k+2)
+//
+// The division is exact, but the product C(k) * 2(2k+1) can overflow even
+// when C(k+1) fits. Dividing g = gcd(C(k), k+2) out of C(k) first leaves
+// (k+2)/g dividing 2(2k+1), so
+//   C(k+1) = (C(k) / g) * (2(2k+1) / ((k+2) / g))
+// and the only possible overflow is in that last multiplication.
+// ------------------------------------------------------------
+
+static u128 gcdU128(u128 a, u128 b) {
+    while (b) {
+        u128 t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Catalan number in 128 bits, returns false if it does not fit (n > 69)
+bool catalanU128(int n, u128 *out) {
+    u128 c = 1;
+    for (int k = 0; k < n; k++) {
+        u128 g = gcdU128(c, (u128)k + 2);
+        if (__builtin_mul_overflow(c / g, (2 * (2 * (u128)k + 1)) / (((u128)k + 2) / g), &c)) {
+            return false;
+        }
+    }
+    *out = c;
+    return true;
+}
+
+// Fills table[0..] with C(0), C(1), ... in 128 bits using the same recurrence,
+// stopping at the first overflow or at max entries. Returns the entry count.
+int catalanTable(u128 *table, int max) {
+    if (max <= 0) {
+        return 0;
+    }
+    table[0] = 1;
+    int count = 1;
+    while (count < max && catalanU128(count, &table[count])) {
+        count++;
+    }
+    return count;
+}
+
+// Writes a 128-bit value in decimal
+void printU128(FILE *out, u128 v) {
+    char digits[40];
+    int len = 0;
+    do {
+        digits[len++] = (char)('0' + (int)(v % 10));
+        v /= 10;
+    } while (v);
+    while (len > 0) {
+        fputc(digits[--len], out);
+    }
+}
+
+// ------------------------------------------------------------
+// Arbitrary precision
+//
+// BigInt stores base 2^32 limbs, least significant first. C(n) for big n
+// is built from its prime factorization
+//   C(n) = (2n)! / (n! (n+1)!)  =  prod p^e(p)
+// where e(p) comes from Legendre's formula. The prime powers are packed
+// into 32-bit words and multiplied with a balanced product tree, so the
+// large multiplications are between numbers of similar size, which is
+// where Karatsuba (O(L^1.585) for L limbs) pays off.
+// ------------------------------------------------------------
+
+typedef struct {
+    uint32_t *limb;
+    size_t len;
+} BigInt;
+
+static void bigFree(BigInt *x) {
+    free(x->limb);
+    x->limb = NULL;
+    x->len = 0;
+}
+
+// dst[0..nd) += src[0..ns), returns the carry out of dst (ns <= nd)
+static uint32_t addInto(uint32_t *dst, size_t nd, const uint32_t *src, size_t ns) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < ns; i++) {
+        carry += (uint64_t)dst[i] + src[i];
+        dst[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    for (; carry && i < nd; i++) {
+        carry += dst[i];
+        dst[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    return (uint32_t)carry;
+}
+
+// dst[0..nd) -= src[0..ns), requires dst >= src (ns <= nd)
+static void subFrom(uint32_t *dst, size_t nd, const uint32_t *src, size_t ns) {
+    int64_t borrow = 0;
+    size_t i = 0;
+    for (; i < ns; i++) {
+        int64_t d = (int64_t)dst[i] - src[i] - borrow;
+        borrow = d < 0;
+        dst[i] = (uint32_t)d;
+    }
+    for (; borrow && i < nd; i++) {
+        borrow = dst[i] == 0;
+        dst[i]--;
+    }
+}
+
+// out[0..na+nb) = a * b, schoolbook
+static void mulSchool(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    memset(out, 0, (na + nb) * sizeof(uint32_t));
+    for (size_t i = 0; i < na; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < nb; j++) {
+            carry += (uint64_t)a[i] * b[j] + out[i + j];
+            out[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        out[i + nb] = (uint32_t)carry;
+    }
+}
+
+static size_t trimmed(const uint32_t *x, size_t n) {
+    while (n > 0 && x[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+// out[0..na+nb) = a * b, Karatsuba
+//   a = a1*B^m + a0, b = b1*B^m + b0
+//   a*b = z2*B^2m + (z1 - z2 - z0)*B^m + z0, z1 = (a0+a1)(b0+b1)
+// Three half-size products instead of four. A much shorter b is handled in
+// chunks of its own length so the recursion stays balanced.
+// Returns false if a scratch allocation fails (out is then undefined).
+static bool mulKaratsuba(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    if (na < nb) {
+        const uint32_t *t = a; a = b; b = t;
+        size_t tn = na; na = nb; nb = tn;
+    }
+    if (nb < KARATSUBA_THRESHOLD) {
+        mulSchool(a, na, b, nb, out);
+        return true;
+    }
+
+    if (nb <= na / 2) {
+        memset(out, 0, (na + nb) * sizeof(uint32_t));
+        uint32_t *part = malloc((2 * nb) * sizeof(uint32_t));
+        if (!part) {
+            return false;
+        }
+        for (size_t off = 0; off < na; off += nb) {
+            size_t len = (na - off < nb) ? na - off : nb;
+            if (!mulKaratsuba(a + off, len, b, nb, part)) {
+                free(part);
+                return false;
+            }
+            addInto(out + off, na + nb - off, part, len + nb);
+        }
+        free(part);
+        return true;
+    }
+
+    size_t m = na / 2;                    // nb > m here
+    size_t la1 = na - m, lb1 = nb - m;
+    size_t lsa = la1 + 1, lsb = (m > lb1 ? m : lb1) + 1;
+    uint32_t *sa = calloc(lsa + lsb + lsa + lsb, sizeof(uint32_t));
+    if (!sa) {
+        return false;
+    }
+    uint32_t *sb = sa + lsa;
+    uint32_t *z1 = sb + lsb;
+
+    // sa = a0 + a1, sb = b0 + b1
+    memcpy(sa, a + m, la1 * sizeof(uint32_t));
+    addInto(sa, lsa, a, m);
+    memcpy(sb, b, m * sizeof(uint32_t));
+    addInto(sb, lsb, b + m, lb1);
+
+    bool ok = mulKaratsuba(a, m, b, m, out)                  // z0 -> out[0..2m)
+           && mulKaratsuba(a + m, la1, b + m, lb1, out + 2 * m)  // z2 -> out[2m..na+nb)
+           && mulKaratsuba(sa, lsa, sb, lsb, z1);
+    if (!ok) {
+        free(sa);
+        return false;
+    }
+
+    subFrom(z1, lsa + lsb, out, 2 * m);
+    subFrom(z1, lsa + lsb, out + 2 * m, la1 + lb1);
+    addInto(out + m, na + nb - m, z1, trimmed(z1, lsa + lsb));
+    free(sa);
+    return true;
+}
+
+// *r = a * b as a new BigInt, returns false if memory runs out
+static bool bigMul(const BigInt *a, const BigInt *b, BigInt *r) {
+    r->len = a->len + b->len;
+    r->limb = malloc(r->len * sizeof(uint32_t));
+    if (!r->limb || !mulKaratsuba(a->limb, a->len, b->limb, b->len, r->limb)) {
+        bigFree(r);
+        return false;
+    }
+    r->len = trimmed(r->limb, r->len);
+    return true;
+}
+
+// Frees words[0..count) and the array itself
+static void bigFreeAll(BigInt *words, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        bigFree(&words[i]);
+    }
+    free(words);
+}
+
+// Appends a one-limb BigInt, growing the array; returns false if memory runs out
+static bool pushWord(BigInt **words, size_t *count, size_t *cap, uint32_t value) {
+    if (*count == *cap) {
+        BigInt *grown = realloc(*words, 2 * *cap * sizeof(BigInt));
+        if (!grown) {
+            return false;
+        }
+        *words = grown;
+        *cap *= 2;
+    }
+    BigInt *w = &(*words)[*count];
+    w->limb = malloc(sizeof(uint32_t));
+    if (!w->limb) {
+        return false;
+    }
+    w->limb[0] = value;
+    w->len = 1;
+    (*count)++;
+    return true;
+}
+
+// Exponent of prime p in m! (Legendre's formula)
+static long long legendre(long long m, long long p) {
+    long long e = 0;
+    while (m) {
+        m /= p;
+        e += m;
+    }
+    return e;
+}
+
+// Catalan number of any size, returns false if memory runs out
+bool catalanBig(int n, BigInt *out) {
+    long long limit = 2LL * n;
+    char *composite = calloc((size_t)limit + 1, 1);
+    size_t cap = 64, count = 0;
+    BigInt *words = malloc(cap * sizeof(BigInt));
+    if (!composite || !words) {
+        free(composite);
+        free(words);
+        return false;
+    }
+
+    // Sieve primes up to 2n and pack p^e(p) into 32-bit words
+    uint64_t word = 1;
+    for (long long p = 2; p <= limit; p++) {
+        if (composite[p]) {
+            continue;
+        }
+        for (long long q = p * p; q <= limit; q += p) {
+            composite[q] = 1;
+        }
+        long long e = legendre(limit, p) - legendre(n, p) - legendre(n + 1, p);
+        for (long long i = 0; i < e; i++) {
+            if (word * (uint64_t)p > UINT32_MAX) {
+                if (!pushWord(&words, &count, &cap, (uint32_t)word)) {
+                    free(composite);
+                    bigFreeAll(words, count);
+                    return false;
+                }
+                word = 1;
+            }
+            word *= (uint64_t)p;
+        }
+    }
+    free(composite);
+    if (!pushWord(&words, &count, &cap, (uint32_t)word)) {
+        bigFreeAll(words, count);
+        return false;
+    }
+
+    // Balanced product tree: multiply neighbours until one number is left
+    while (count > 1) {
+        size_t half = 0;
+        for (size_t i = 0; i + 1 < count; i += 2) {
+            BigInt prod;
+            if (!bigMul(&words[i], &words[i + 1], &prod)) {
+                // words[0..half) hold this round's products, words[i..count) are not consumed yet
+                for (size_t j = i; j < count; j++) {
+                    bigFree(&words[j]);
+                }
+                bigFreeAll(words, half);
+                return false;
+            }
+            bigFree(&words[i]);
+            bigFree(&words[i + 1]);
+            words[half++] = prod;
+        }
+        if (count % 2 == 1) {
+            words[half++] = words[count - 1];
+        }
+        count = half;
+    }
+    *out = words[0];
+    free(words);
+    return true;
+}
+
+// Converts a BigInt to a decimal string (caller frees)
+// Repeated division by 10^9: O(L^2) for L limbs
+// Returns NULL if memory runs out
+char *bigToDecimal(const BigInt *x) {
+    size_t n = trimmed(x->limb, x->len);
+    uint32_t *work = malloc((n ? n : 1) * sizeof(uint32_t));
+    uint32_t *chunks = malloc((n * 10 / 9 + 2) * sizeof(uint32_t));   // base 10^9 digits
+    if (!work || !chunks) {
+        free(work);
+        free(chunks);
+        return NULL;
+    }
+    memcpy(work, x->limb, n * sizeof(uint32_t));
+
+    size_t nchunks = 0;
+    while (n > 0) {
+        uint64_t rem = 0;
+        for (size_t i = n; i-- > 0;) {
+            uint64_t cur = (rem << 32) | work[i];
+            work[i] = (uint32_t)(cur / 1000000000u);
+            rem = cur % 1000000000u;
+        }
+        chunks[nchunks++] = (uint32_t)rem;
+        n = trimmed(work, n);
+    }
+
+    char *s = malloc(nchunks * 9 + 2);
+    if (!s) {
+        free(work);
+        free(chunks);
+        return NULL;
+    }
+    if (nchunks == 0) {
+        strcpy(s, "0");
+    } else {
+        int len = sprintf(s, "%u", chunks[nchunks - 1]);
+        for (size_t i = nchunks - 1; i-- > 0;) {
+            len += sprintf(s + len, "%09u", chunks[i]);
+        }
+    }
+    free(work);
+    free(chunks);
+    return s;
+}
+
+// Prints C(n) exactly: lookup table if it fits in 128 bits, big integers otherwise
+void printCatalan(FILE *out, int n, const u128 *table, int tableLen) {
+    if (n < tableLen) {
+        printU128(out, table[n]);
+        return;
+    }
+    BigInt c;
+    if (!catalanBig(n, &c)) {
+        fputs("out of memory", out);
+        return;
+    }
+    char *digits = bigToDecimal(&c);
+    fputs(digits ? digits : "out of memory", out);
+    free(digits);
+    bigFree(&c);
+}
+
+// ------------------------------------------------------------
+// Catalan numbers modulo a prime p (p < 2^32)
+//
+//   C(n) = (2n)! / (n! (n+1)!)  =  fact[2n] * invFact[n] * invFact[n+1]  (mod p)
+//
+// fact and invFact are built once in O(size): one modular inverse (Fermat)
+// of the largest factorial, then invFact[i-1] = invFact[i] * i. Each query
+// is then O(1). This needs p > 2n, because p | (2n)! otherwise.
+//
+// For small primes (p <= 2n) Lucas's theorem is used instead:
+//   binom(a, b) = prod binom(a_i, b_i)  (mod p)  over the base-p digits,
+// so only factorials below p are needed, and
+//   C(n) = binom(2n, n) - binom(2n, n+1)
+// avoids dividing by n+1 (which p may divide).
+// ------------------------------------------------------------
+
+typedef struct {
+    uint32_t p;
+    size_t size;        // fact / invFact cover 0 .. size-1
+    uint32_t *fact;
+    uint32_t *invFact;
+} ModTable;
+
+static uint32_t powMod(uint32_t base, uint64_t exp, uint32_t p) {
+    uint64_t result = 1 % p, b = base % p;
+    while (exp) {
+        if (exp & 1) result = result * b % p;
+        b = b * b % p;
+        exp >>= 1;
+    }
+    return (uint32_t)result;
+}
+
+// Deterministic Miller-Rabin for 32-bit numbers (bases 2, 7, 61)
+bool isPrime32(uint32_t n) {
+    if (n < 2) return false;
+    static const uint32_t bases[] = {2, 7, 61};
+    uint32_t d = n - 1;
+    int r = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        r++;
+    }
+    for (int i = 0; i < 3; i++) {
+        uint32_t a = bases[i] % n;
+        if (a == 0) continue;
+        uint64_t x = powMod(a, d, n);
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int j = 1; j < r && composite; j++) {
+            x = x * x % n;
+            if (x == n - 1) composite = false;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+// Prepares factorials mod p for queries with n <= maxN
+bool modTableInit(ModTable *t, uint32_t p, uint64_t maxN) {
+    t->p = p;
+    t->size = (2 * maxN + 2 < p) ? (size_t)(2 * maxN + 2) : p;   // 0 .. 2n+1; Lucas needs only 0 .. p-1
+    t->fact = malloc(t->size * sizeof(uint32_t));
+    t->invFact = malloc(t->size * sizeof(uint32_t));
+    if (!t->fact || !t->invFact) {
+        free(t->fact);
+        free(t->invFact);
+        return false;
+    }
+
+    t->fact[0] = 1 % p;
+    for (size_t i = 1; i < t->size; i++) {
+        t->fact[i] = (uint32_t)((uint64_t)t->fact[i - 1] * i % p);
+    }
+    t->invFact[t->size - 1] = powMod(t->fact[t->size - 1], p - 2, p);
+    for (size_t i = t->size - 1; i > 0; i--) {
+        t->invFact[i - 1] = (uint32_t)((uint64_t)t->invFact[i] * i % p);
+    }
+    return true;
+}
+
+void modTableFree(ModTable *t) {
+    free(t->fact);
+    free(t->invFact);
+}
+
+// binom(a, b) mod p for a, b < size (a single Lucas digit, or any a < p)
+static uint32_t binomSmall(const ModTable *t, uint64_t a, uint64_t b) {
+    if (b > a) return 0;
+    return (uint32_t)((uint64_t)t->fact[a] * t->invFact[b] % t->p * t->invFact[a - b] % t->p);
+}
+
+// binom(a, b) mod p, using Lucas's theorem when a >= p
+uint32_t binomMod(const ModTable *t, uint64_t a, uint64_t b) {
+    if (b > a) return 0;
+    if (a < t->size) return binomSmall(t, a, b);
+
+    uint64_t result = 1 % t->p;
+    while (a > 0 || b > 0) {
+        uint64_t ai = a % t->p, bi = b % t->p;
+        if (bi > ai) return 0;
+        result = result * binomSmall(t, ai, bi) % t->p;
+        a /= t->p;
+        b /= t->p;
+    }
+    return (uint32_t)result;
+}
+
+// C(n) mod p in O(1) when 2n < p, O(log_p n) with Lucas otherwise
+uint32_t catalanMod(const ModTable *t, uint64_t n) {
+    uint32_t p = t->p;
+    if (2 * n + 1 < t->size) {   // fact[2n] and invFact[n + 1] are both in the table
+        return (uint32_t)((uint64_t)t->fact[2 * n] * t->invFact[n] % p * t->invFact[n + 1] % p);
+    }
+    return (uint32_t)(((uint64_t)binomMod(t, 2 * n, n) + p - binomMod(t, 2 * n, n + 1)) % p);
+}
+
+// Reads every integer in a file ("-" for stdin) into a growing array
+static long long *readValues(const char *filename, size_t *count) {
+    FILE *in = (strcmp(filename, "-") == 0) ? stdin : fopen(filename, "r");
+    if (!in) {
+        return NULL;
+    }
+    size_t cap = 1024;
+    long long *values = malloc(cap * sizeof(long long));
+    long long v;
+    *count = 0;
+    while (values && fscanf(in, "%lld", &v) == 1) {
+        if (*count == cap) {
+            cap *= 2;
+            long long *grown = realloc(values, cap * sizeof(long long));
+            if (!grown) {
+                free(values);
+                values = NULL;
+                break;
+            }
+            values = grown;
+        }
+        values[(*count)++] = v;
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    return values;
+}
+
+// Batch mode mod p: reads all n values, builds the table once for the
+// largest one, then prints "n C(n) mod p" for each
+int runBatchMod(const char *filename, uint32_t p) {
+    size_t count;
+    long long *values = readValues(filename, &count);
+    if (!values) {
+        printf("Could not read %s\n", filename);
         return 1;
     }
-    
-    long long result = 0;
-    for (int i = 0; i < n; i++) {
-        result += catalan(i) * catalan(n - 1 - i);
+    long long maxN = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (values[i] > maxN) maxN = values[i];
     }
-    
-    return result;
+
+    ModTable table;
+    if (!modTableInit(&table, p, (uint64_t)maxN)) {
+        printf("Out of memory for n up to %lld\n", maxN);
+        free(values);
+        return 1;
+    }
+    static char buffer[1 << 20];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    for (size_t i = 0; i < count; i++) {
+        if (values[i] < 0) {
+            printf("%lld invalid\n", values[i]);
+        } else {
+            printf("%lld %u\n", values[i], catalanMod(&table, (uint64_t)values[i]));
+        }
+    }
+    fflush(stdout);
+    modTableFree(&table);
+    free(values);
+    return 0;
+}
+
+// Batch mode: reads n values (one per token) from a file, "-" for stdin,
+// and prints "n C(n)" for each using the precomputed table
+int runBatch(const char *filename, const u128 *table, int tableLen) {
+    size_t count;
+    long long *values = readValues(filename, &count);
+    if (!values) {
+        printf("Could not read %s\n", filename);
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (values[i] < 0 || values[i] > INT32_MAX) {
+            printf("%lld invalid\n", values[i]);
+            continue;
+        }
+        printf("%lld ", values[i]);
+        printCatalan(stdout, (int)values[i], table, tableLen);
+        putchar('\n');
+    }
+    free(values);
+    return 0;
 }
 
-// Optimized function using dynamic programming
-long long catalanDP(int n) {
+// ------------------------------------------------------------
+// Enumerating the tree shapes themselves
+//
+// A binary tree with n nodes is written as a balanced-parentheses word of
+// length 2n: tree = "(" left ")" right, the empty tree is "". Shapes are
+// visited in lexicographic order with ')' < '(' (from "()()...()" to
+// "((...))") by Knuth's Algorithm P (TAOCP 7.2.1.6), which changes only the
+// tail of the word and costs O(1) amortized per shape.
+//
+// rankShape / unrankShape map a word to its position in that order and back
+// using ballot numbers, so [first, first + count) ranges can be generated
+// independently (e.g. one range per thread).
+// ------------------------------------------------------------
+
+#define MAX_RANK_N 64   // Ranks of shapes with up to 64 nodes fit in 128 bits
+
+// completions[o][c]: ways to finish a word with o '(' and c ')' still to
+// place (c >= o), never closing more than was opened
+static u128 completions[MAX_RANK_N + 1][MAX_RANK_N + 1];
+static bool completionsReady = false;
+
+static void initCompletions(void) {
+    if (completionsReady) return;
+    for (int c = 0; c <= MAX_RANK_N; c++) {
+        completions[0][c] = 1;
+        for (int o = 1; o <= c; o++) {
+            // Next char is '(' or, if the balance allows it, ')'
+            completions[o][c] = completions[o - 1][c] + (c - 1 >= o ? completions[o][c - 1] : 0);
+        }
+    }
+    completionsReady = true;
+}
+
+// Position of a word among all shapes of its size, returns false if it is not balanced
+bool rankShape(const char *word, int n, u128 *rank) {
+    if (n > MAX_RANK_N) return false;
+    initCompletions();
+    u128 r = 0;
+    int opened = 0, closed = 0;
+    for (int i = 0; i < 2 * n; i++) {
+        if (word[i] == '(') {
+            // Every word with ')' here (if allowed) comes first
+            if (closed < opened) {
+                r += completions[n - opened][n - closed - 1];
+            }
+            if (++opened > n) return false;
+        } else if (word[i] == ')') {
+            if (++closed > opened) return false;
+        } else {
+            return false;
+        }
+    }
+    *rank = r;
+    return true;
+}
+
+// Writes the shape with the given rank into word[0..2n) (plus '\0')
+bool unrankShape(int n, u128 rank, char *word) {
+    if (n > MAX_RANK_N) return false;
+    initCompletions();
+    if (rank >= completions[n][n]) return false;
+    int opened = 0, closed = 0;
+    for (int i = 0; i < 2 * n; i++) {
+        u128 withClose = (closed < opened) ? completions[n - opened][n - closed - 1] : 0;
+        if (rank < withClose) {
+            word[i] = ')';
+            closed++;
+        } else {
+            rank -= withClose;
+            word[i] = '(';
+            opened++;
+        }
+    }
+    word[2 * n] = '\0';
+    return true;
+}
+
+// Called for each shape; returning non-zero stops the enumeration
+typedef int (*ShapeVisitor)(const char *word, int n, void *ctx);
+
+// Visits count shapes starting at the one with rank first (count = 0: to the end)
+// Returns the number of shapes visited
+unsigned long long enumerateShapes(int n, u128 first, unsigned long long count, ShapeVisitor visit, void *ctx) {
     if (n <= 1) {
+        // Algorithm P needs n >= 2; the empty tree and the single node are one shape each
+        if (first != 0) return 0;
+        visit(n == 0 ? "" : "()", n, ctx);
         return 1;
     }
-    
-    long long dp[n + 1];
-    dp[0] = dp[1] = 1;
-    
-    for (int i = 2; i <= n; i++) {
-        dp[i] = 0;
-        for (int j = 0; j < i; j++) {
-            dp[i] += dp[j] * dp[i - 1 - j];
+    char *a = malloc(2 * (size_t)n + 2);   // 1-based as in Algorithm P, a[0] is a sentinel ')'
+    if (!a || !unrankShape(n, first, a + 1)) {
+        free(a);
+        return 0;
+    }
+    a[0] = ')';
+
+    // m = position of the last '(' (everything after it is ')')
+    int m = 2 * n;
+    while (a[m] != '(') m--;
+
+    unsigned long long visited = 0;
+    for (;;) {
+        // P2. Visit
+        visited++;
+        if (visit(a + 1, n, ctx) != 0 || visited == count) break;
+
+        // P3. Easy case: "()" -> ")(" just before the tail
+        a[m] = ')';
+        if (a[m - 1] == ')') {
+            a[m - 1] = '(';
+            m--;
+            continue;
+        }
+        // P4. Find j: move the run of '(' before m to the end, alternating
+        int j = m - 1, k = 2 * n - 1;
+        while (a[j] == '(') {
+            a[j] = ')';
+            a[k] = '(';
+            j--;
+            k -= 2;
         }
+        // P5. Increase a[j]
+        if (j == 0) break;
+        a[j] = '(';
+        m = 2 * n - 1;
     }
-    
-    return dp[n];
+    free(a);
+    return visited;
 }
 
-int main() {
-    int n;
-    
-    printf("Enter the number of nodes: ");
-    scanf("%d", &n);
+// Writes one word per line to stdout (main gives stdout a 1 MiB buffer first)
+static int printShape(const char *word, int n, void *ctx) {
+    (void)ctx;
+    fwrite(word, 1, 2 * (size_t)n, stdout);
+    putchar('\n');
+    return 0;
+}
+
+// Parses a decimal 128-bit number
+static bool parseU128(const char *s, u128 *out) {
+    u128 v = 0;
+    if (!*s) return false;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return false;
+        v = v * 10 + (u128)(*s - '0');
+    }
+    *out = v;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int n = -1;
+    u128 table[TABLE_MAX_N];
+    int tableLen = catalanTable(table, TABLE_MAX_N);
+    const char *batchFile = NULL;
+    long long modulus = 0;
+    bool haveN = false;
+
+    // ./main [n] [--mod p] [--batch <file>]
+    // ./main --shapes n [first [count]] | --rank <word> | --unrank n k
+    if (argc > 2 && strcmp(argv[1], "--shapes") == 0) {
+        u128 first = 0;
+        unsigned long long count = 0;
+        n = atoi(argv[2]);
+        if (n < 0 || n > MAX_RANK_N || (argc > 3 && !parseU128(argv[3], &first))) {
+            printf("Invalid shape range.\n");
+            return 1;
+        }
+        if (argc > 4) count = strtoull(argv[4], NULL, 10);
+        static char buffer[1 << 20];
+        setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+        enumerateShapes(n, first, count, printShape, NULL);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "--rank") == 0) {
+        u128 rank;
+        if (!rankShape(argv[2], (int)(strlen(argv[2]) / 2), &rank) || strlen(argv[2]) % 2) {
+            printf("Not a balanced word of at most %d pairs.\n", MAX_RANK_N);
+            return 1;
+        }
+        printU128(stdout, rank);
+        putchar('\n');
+        return 0;
+    }
+    if (argc > 3 && strcmp(argv[1], "--unrank") == 0) {
+        u128 rank;
+        char word[2 * MAX_RANK_N + 1];
+        n = atoi(argv[2]);
+        if (n < 0 || !parseU128(argv[3], &rank) || !unrankShape(n, rank, word)) {
+            printf("Rank out of range.\n");
+            return 1;
+        }
+        printf("%s\n", word);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchFile = argv[++i];
+        } else if (strcmp(argv[i], "--mod") == 0 && i + 1 < argc) {
+            const char *text = argv[++i];
+            char *end;
+            modulus = strtoll(text, &end, 10);
+            if (end == text || *end || modulus < 2 || modulus > UINT32_MAX || !isPrime32((uint32_t)modulus)) {
+                printf("The modulus must be a prime below 2^32.\n");
+                return 1;
+            }
+        } else {
+            n = atoi(argv[i]);
+            haveN = true;
+        }
+    }
+
+    if (batchFile) {
+        return modulus ? runBatchMod(batchFile, (uint32_t)modulus) : runBatch(batchFile, table, tableLen);
+    }
+
+    if (!haveN) {
+        printf("Enter the number of nodes: ");
+        if (scanf("%d", &n) != 1) {
+            printf("Invalid input.\n");
+            return 1;
+        }
+    }
     
     if (n < 0) {
         printf("Number of nodes cannot be negative.\n");
         return 1;
     }
+
+    if (modulus) {
+        ModTable mt;
+        if (!modTableInit(&mt, (uint32_t)modulus, (uint64_t)n)) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+        printf("Number of binary trees with %d unlabelled nodes (mod %lld): %u\n",
+               n, modulus, catalanMod(&mt, (uint64_t)n));
+        modTableFree(&mt);
+        return 0;
+    }
     
-    long long result = catalanDP(n);
-    printf("Number of binary trees with %d unlabelled nodes: %lld\n", n, result);
+    printf("Number of binary trees with %d unlabelled nodes: ", n);
+    printCatalan(stdout, n, table, tableLen);
+    printf("\n");
     
     return 0;
-}
\ No newline at end of file
+}
@@ -4,7 +4,15 @@ Write a function to calculate the nth fibonacci series in the most optimal way.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+typedef unsigned __int128 u128;
 
 /*
 TIME COMPLEXITY: O(n)
@@ -37,11 +45,1251 @@ long long fibonacci_binet(int n){
     return (long long)((pow(phi, n) - pow(psi, n)) / sqrt(5));
 }
 
-int main(){
-    int n;
 
-    printf("Enter the position in Fibonacci series: ");
-    scanf("%d", &n);
+/*
+TIME COMPLEXITY: O(log n)
+Fast doubling. From the matrix form [[1,1],[1,0]]^n one gets
+    F(2k)   = F(k) * (2F(k+1) - F(k))
+    F(2k+1) = F(k)^2 + F(k+1)^2
+so walking the bits of n from the top, the pair (F(k), F(k+1)) doubles k
+(and adds 1 for a set bit) with three multiplications per bit.
+
+The pair is only advanced up to k = n/2; the last step computes F(n) alone,
+because F(n+1) may overflow even when F(n) fits. Every operation is checked,
+so the function returns false instead of a wrong value:
+F(93) is the last value that fits in 64 bits, F(186) the last in 128 bits.
+*/
+bool fibonacci_u64(unsigned long long n, uint64_t *out) {
+    uint64_t a = 0, b = 1;   // F(k), F(k+1), k = 0
+    int top = 63;
+    while (top > 0 && !((n >> top) & 1)) top--;
+
+    // Build (F(n/2), F(n/2 + 1)) from the bits above the lowest one
+    for (int bit = top; bit >= 1; bit--) {
+        uint64_t twoB, diff, c, aa, bb, d;
+        if (__builtin_mul_overflow(b, 2, &twoB) || __builtin_sub_overflow(twoB, a, &diff) ||
+            __builtin_mul_overflow(a, diff, &c) || __builtin_mul_overflow(a, a, &aa) ||
+            __builtin_mul_overflow(b, b, &bb) || __builtin_add_overflow(aa, bb, &d)) {
+            return false;
+        }
+        if ((n >> bit) & 1) {
+            a = d;
+            if (__builtin_add_overflow(c, d, &b)) return false;
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+
+    // Last bit: only F(n) itself
+    uint64_t r, t;
+    if (n & 1) {
+        if (__builtin_mul_overflow(a, a, &r) || __builtin_mul_overflow(b, b, &t) || __builtin_add_overflow(r, t, &r)) return false;
+    } else {
+        if (__builtin_mul_overflow(b, 2, &t) || __builtin_sub_overflow(t, a, &t) || __builtin_mul_overflow(a, t, &r)) return false;
+    }
+    *out = r;
+    return true;
+}
+
+// Same as fibonacci_u64 with 128-bit results
+bool fibonacci_u128(unsigned long long n, u128 *out) {
+    u128 a = 0, b = 1;
+    int top = 63;
+    while (top > 0 && !((n >> top) & 1)) top--;
+
+    for (int bit = top; bit >= 1; bit--) {
+        u128 twoB, diff, c, aa, bb, d;
+        if (__builtin_mul_overflow(b, 2, &twoB) || __builtin_sub_overflow(twoB, a, &diff) ||
+            __builtin_mul_overflow(a, diff, &c) || __builtin_mul_overflow(a, a, &aa) ||
+            __builtin_mul_overflow(b, b, &bb) || __builtin_add_overflow(aa, bb, &d)) {
+            return false;
+        }
+        if ((n >> bit) & 1) {
+            a = d;
+            if (__builtin_add_overflow(c, d, &b)) return false;
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+
+    u128 r, t;
+    if (n & 1) {
+        if (__builtin_mul_overflow(a, a, &r) || __builtin_mul_overflow(b, b, &t) || __builtin_add_overflow(r, t, &r)) return false;
+    } else {
+        if (__builtin_mul_overflow(b, 2, &t) || __builtin_sub_overflow(t, a, &t) || __builtin_mul_overflow(a, t, &r)) return false;
+    }
+    *out = r;
+    return true;
+}
+
+// Writes a 128-bit value in decimal
+void print_u128(u128 v) {
+    char digits[40];
+    int len = 0;
+    do {
+        digits[len++] = (char)('0' + (int)(v % 10));
+        v /= 10;
+    } while (v);
+    while (len > 0) putchar(digits[--len]);
+}
+
+
+/*
+BIG INTEGERS
+Numbers are stored as base 10^9 limbs (least significant first), so the
+result prints directly with no base conversion, which would otherwise cost
+more than computing F(n) itself for n in the millions.
+A limb product is below 10^18, so schoolbook multiplication accumulates in
+64 bits with a carry after every step.
+
+Multiplication is Karatsuba above KARATSUBA_THRESHOLD limbs:
+    a = a1*B^m + a0, b = b1*B^m + b0
+    a*b = z2*B^2m + (z1 - z2 - z0)*B^m + z0,  z1 = (a0+a1)(b0+b1)
+three half-size products instead of four: O(L^1.585) for L limbs.
+
+TIME COMPLEXITY (fibonacci_big): O(M(L)) where L ~ 0.0232 n limbs, since the
+operand size doubles at every step of the fast doubling loop.
+*/
+#define BIG_BASE 1000000000u
+#define KARATSUBA_THRESHOLD 40
+
+typedef struct {
+    uint32_t *limb;
+    size_t len;      // Significant limbs (0 for the value 0)
+} BigInt;
+
+static size_t trimmed(const uint32_t *x, size_t n) {
+    while (n > 0 && x[n - 1] == 0) n--;
+    return n;
+}
+
+// dst[0..nd) += src[0..ns), returns the carry out (ns <= nd)
+static uint32_t add_into(uint32_t *dst, size_t nd, const uint32_t *src, size_t ns) {
+    uint32_t carry = 0;
+    size_t i = 0;
+    for (; i < ns; i++) {
+        uint32_t s = dst[i] + src[i] + carry;
+        carry = s >= BIG_BASE;
+        dst[i] = carry ? s - BIG_BASE : s;
+    }
+    for (; carry && i < nd; i++) {
+        uint32_t s = dst[i] + 1;
+        carry = s == BIG_BASE;
+        dst[i] = carry ? 0 : s;
+    }
+    return carry;
+}
+
+// dst[0..nd) -= src[0..ns), requires dst >= src (ns <= nd)
+static void sub_from(uint32_t *dst, size_t nd, const uint32_t *src, size_t ns) {
+    uint32_t borrow = 0;
+    size_t i = 0;
+    for (; i < ns; i++) {
+        uint32_t sub = src[i] + borrow;
+        borrow = dst[i] < sub;
+        dst[i] = borrow ? dst[i] + BIG_BASE - sub : dst[i] - sub;
+    }
+    for (; borrow && i < nd; i++) {
+        borrow = dst[i] == 0;
+        dst[i] = borrow ? BIG_BASE - 1 : dst[i] - 1;
+    }
+}
+
+// out[0..na+nb) = a * b, schoolbook
+static void mul_school(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    memset(out, 0, (na + nb) * sizeof(uint32_t));
+    for (size_t i = 0; i < na; i++) {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+        for (size_t j = 0; j < nb; j++) {
+            uint64_t cur = out[i + j] + ai * b[j] + carry;
+            carry = cur / BIG_BASE;
+            out[i + j] = (uint32_t)(cur - carry * BIG_BASE);
+        }
+        out[i + nb] = (uint32_t)carry;
+    }
+}
+
+// out[0..na+nb) = a * b, Karatsuba (chunks of b when b is much shorter than a).
+// Returns false if scratch space cannot be allocated.
+static bool mul_karatsuba(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    if (na < nb) {
+        const uint32_t *t = a; a = b; b = t;
+        size_t tn = na; na = nb; nb = tn;
+    }
+    if (nb < KARATSUBA_THRESHOLD) {
+        mul_school(a, na, b, nb, out);
+        return true;
+    }
+    if (nb <= na / 2) {
+        memset(out, 0, (na + nb) * sizeof(uint32_t));
+        uint32_t *part = malloc(2 * nb * sizeof(uint32_t));
+        if (!part) return false;
+        for (size_t off = 0; off < na; off += nb) {
+            size_t len = (na - off < nb) ? na - off : nb;
+            if (!mul_karatsuba(a + off, len, b, nb, part)) {
+                free(part);
+                return false;
+            }
+            add_into(out + off, na + nb - off, part, len + nb);
+        }
+        free(part);
+        return true;
+    }
+
+    size_t m = na / 2;                     // nb > m here
+    size_t la1 = na - m, lb1 = nb - m;
+    size_t lsa = la1 + 1, lsb = (m > lb1 ? m : lb1) + 1;
+    uint32_t *sa = calloc(2 * (lsa + lsb), sizeof(uint32_t));
+    if (!sa) return false;
+    uint32_t *sb = sa + lsa;
+    uint32_t *z1 = sb + lsb;
+
+    memcpy(sa, a + m, la1 * sizeof(uint32_t));
+    add_into(sa, lsa, a, m);
+    memcpy(sb, b, m * sizeof(uint32_t));
+    add_into(sb, lsb, b + m, lb1);
+
+    bool ok = mul_karatsuba(a, m, b, m, out)                        // z0
+           && mul_karatsuba(a + m, la1, b + m, lb1, out + 2 * m)    // z2
+           && mul_karatsuba(sa, lsa, sb, lsb, z1);
+    if (ok) {
+        sub_from(z1, lsa + lsb, out, 2 * m);
+        sub_from(z1, lsa + lsb, out + 2 * m, la1 + lb1);
+        add_into(out + m, na + nb - m, z1, trimmed(z1, lsa + lsb));
+    }
+    free(sa);
+    return ok;
+}
+
+static void big_free(BigInt *x) {
+    free(x->limb);
+    x->limb = NULL;
+    x->len = 0;
+}
+
+// The constructors below return false when out of memory, leaving *r empty
+static bool big_from_u32(uint32_t v, BigInt *r) {
+    *r = (BigInt){malloc(2 * sizeof(uint32_t)), 0};
+    if (!r->limb) return false;
+    if (v >= BIG_BASE) {
+        r->limb[0] = v % BIG_BASE;
+        r->limb[1] = v / BIG_BASE;
+        r->len = 2;
+    } else if (v) {
+        r->limb[0] = v;
+        r->len = 1;
+    }
+    return true;
+}
+
+static bool big_mul(const BigInt *a, const BigInt *b, BigInt *r) {
+    *r = (BigInt){malloc((a->len + b->len + 1) * sizeof(uint32_t)), 0};
+    if (!r->limb) return false;
+    if (a->len && b->len) {
+        if (!mul_karatsuba(a->limb, a->len, b->limb, b->len, r->limb)) {
+            big_free(r);
+            return false;
+        }
+        r->len = trimmed(r->limb, a->len + b->len);
+    }
+    return true;
+}
+
+static bool big_add(const BigInt *a, const BigInt *b, BigInt *r) {
+    const BigInt *big = a->len >= b->len ? a : b, *small = a->len >= b->len ? b : a;
+    *r = (BigInt){malloc((big->len + 1) * sizeof(uint32_t)), big->len};
+    if (!r->limb) {
+        r->len = 0;
+        return false;
+    }
+    memcpy(r->limb, big->limb, big->len * sizeof(uint32_t));
+    r->limb[big->len] = 0;
+    if (add_into(r->limb, big->len, small->limb, small->len)) {
+        r->limb[r->len++] = 1;
+    }
+    return true;
+}
+
+// a - b, requires a >= b
+static bool big_sub(const BigInt *a, const BigInt *b, BigInt *r) {
+    *r = (BigInt){malloc((a->len + 1) * sizeof(uint32_t)), a->len};
+    if (!r->limb) {
+        r->len = 0;
+        return false;
+    }
+    memcpy(r->limb, a->limb, a->len * sizeof(uint32_t));
+    sub_from(r->limb, a->len, b->limb, b->len);
+    r->len = trimmed(r->limb, r->len);
+    return true;
+}
+
+/*
+TIME COMPLEXITY: O(M(L)), L ~ n * log10(phi) / 9 limbs
+Fast doubling on big integers: exact F(n) for n in the millions.
+*/
+bool fibonacci_big(unsigned long long n, BigInt *out) {
+    BigInt a, b;                                        // F(k), F(k+1)
+    bool ok = big_from_u32(0, &a) & big_from_u32(1, &b);
+    int top = 63;
+    while (top >= 0 && !((n >> top) & 1)) top--;
+
+    for (int bit = top; ok && bit >= 0; bit--) {
+        BigInt twoB = {0}, diff = {0}, c = {0}, aa = {0}, bb = {0}, d = {0};
+        ok = big_add(&b, &b, &twoB) && big_sub(&twoB, &a, &diff)
+          && big_mul(&a, &diff, &c)             // F(2k)
+          && big_mul(&a, &a, &aa) && big_mul(&b, &b, &bb)
+          && big_add(&aa, &bb, &d);             // F(2k+1)
+        big_free(&twoB);
+        big_free(&diff);
+        big_free(&aa);
+        big_free(&bb);
+        big_free(&a);
+        big_free(&b);
+        if (!ok) {
+            big_free(&c);
+            big_free(&d);
+        } else if ((n >> bit) & 1) {
+            ok = big_add(&c, &d, &b);
+            a = d;
+            big_free(&c);
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+    big_free(&b);
+    if (!ok) {
+        big_free(&a);
+        return false;
+    }
+    *out = a;
+    return true;
+}
+
+// Prints a big integer in decimal (limbs are already base 10^9)
+void big_print(const BigInt *x) {
+    if (x->len == 0) {
+        putchar('0');
+        return;
+    }
+    printf("%u", x->limb[x->len - 1]);
+    for (size_t i = x->len - 1; i-- > 0;) {
+        printf("%09u", x->limb[i]);
+    }
+}
+
+// Number of decimal digits of a big integer
+size_t big_digits(const BigInt *x) {
+    if (x->len == 0) return 1;
+    size_t digits = 9 * (x->len - 1);
+    for (uint32_t top = x->limb[x->len - 1]; top; top /= 10) digits++;
+    return digits;
+}
+
+
+/*
+FIBONACCI MODULO m
+Fast doubling where every product is reduced mod m. The reduction is the
+hot spot, so it avoids the 128-bit division of a plain %:
+- m < 2^32: Barrett reduction. Products fit in 64 bits and
+  x mod m = x - floor(x * r / 2^64) * m (plus at most two corrections),
+  with r = floor(2^64 / m) computed once per modulus.
+- odd m: Montgomery multiplication. Numbers are kept as a * 2^64 mod m and
+  REDC replaces the division by two multiplications and a shift.
+- even m >= 2^32: plain 128-bit %.
+
+TIME COMPLEXITY: O(log n) per query
+*/
+typedef struct {
+    uint64_t m;
+    uint64_t r;       // floor((2^64 - 1) / m)
+} Barrett;
+
+static Barrett barrett_init(uint64_t m) {
+    Barrett b = {m, UINT64_MAX / m};
+    return b;
+}
+
+static inline uint64_t barrett_reduce(const Barrett *b, uint64_t x) {
+    uint64_t q = (uint64_t)(((u128)x * b->r) >> 64);
+    uint64_t res = x - q * b->m;
+    while (res >= b->m) res -= b->m;
+    return res;
+}
+
+typedef struct {
+    uint64_t m;
+    uint64_t minv;    // m^-1 mod 2^64
+    uint64_t r2;      // 2^128 mod m
+} Montgomery;
+
+static Montgomery montgomery_init(uint64_t m) {
+    Montgomery mg = {m, m, 0};
+    for (int i = 0; i < 6; i++) mg.minv *= 2 - m * mg.minv;   // Newton: doubles the correct bits
+    uint64_t r = (0 - m) % m;                                 // 2^64 mod m
+    mg.r2 = (uint64_t)((u128)r * r % m);
+    return mg;
+}
+
+// t * 2^-64 mod m, for t < m * 2^64
+static inline uint64_t redc(const Montgomery *mg, u128 t) {
+    uint64_t q = (uint64_t)t * mg->minv;
+    uint64_t qm_hi = (uint64_t)(((u128)q * mg->m) >> 64);
+    uint64_t t_hi = (uint64_t)(t >> 64);
+    return t_hi >= qm_hi ? t_hi - qm_hi : t_hi - qm_hi + mg->m;
+}
+
+static inline uint64_t add_mod(uint64_t a, uint64_t b, uint64_t m) {
+    uint64_t s = a + b;
+    return (s >= m || s < a) ? s - m : s;
+}
+
+static inline uint64_t sub_mod(uint64_t a, uint64_t b, uint64_t m) {
+    return a >= b ? a - b : a - b + m;
+}
+
+// Fast doubling with Barrett products, m < 2^32
+static uint64_t fibonacci_mod_barrett(uint64_t n, const Barrett *br) {
+    uint64_t m = br->m, a = 0, b = 1 % m;
+    for (int bit = 63 - __builtin_clzll(n | 1); bit >= 0; bit--) {
+        uint64_t c = barrett_reduce(br, a * sub_mod(add_mod(b, b, m), a, m));
+        uint64_t d = add_mod(barrett_reduce(br, a * a), barrett_reduce(br, b * b), m);
+        if ((n >> bit) & 1) {
+            a = d;
+            b = add_mod(c, d, m);
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+    return a;
+}
+
+// Fast doubling in the Montgomery domain, odd m
+static uint64_t fibonacci_mod_montgomery(uint64_t n, const Montgomery *mg) {
+    uint64_t m = mg->m;
+    uint64_t a = 0, b = redc(mg, (u128)(1 % m) * mg->r2);   // 0 and 1 in Montgomery form
+    for (int bit = 63 - __builtin_clzll(n | 1); bit >= 0; bit--) {
+        uint64_t c = redc(mg, (u128)a * sub_mod(add_mod(b, b, m), a, m));
+        uint64_t d = add_mod(redc(mg, (u128)a * a), redc(mg, (u128)b * b), m);
+        if ((n >> bit) & 1) {
+            a = d;
+            b = add_mod(c, d, m);
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+    return redc(mg, a);
+}
+
+// (F(n), F(n+1)) mod m with plain 128-bit %, used for even m >= 2^32 and for period checks
+static void fibonacci_pair_mod(uint64_t n, uint64_t m, uint64_t *fn, uint64_t *fn1) {
+    uint64_t a = 0, b = 1 % m;
+    for (int bit = 63 - __builtin_clzll(n | 1); bit >= 0; bit--) {
+        uint64_t c = (uint64_t)((u128)a * sub_mod(add_mod(b, b, m), a, m) % m);
+        uint64_t d = add_mod((uint64_t)((u128)a * a % m), (uint64_t)((u128)b * b % m), m);
+        if ((n >> bit) & 1) {
+            a = d;
+            b = add_mod(c, d, m);
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+    *fn = a;
+    *fn1 = b;
+}
+
+// F(n) mod m for any m >= 1, picking the fastest reduction
+uint64_t fibonacci_mod(uint64_t n, uint64_t m) {
+    if (m == 1) return 0;
+    if (m <= UINT32_MAX) {
+        Barrett br = barrett_init(m);
+        return fibonacci_mod_barrett(n, &br);
+    }
+    if (m & 1) {
+        Montgomery mg = montgomery_init(m);
+        return fibonacci_mod_montgomery(n, &mg);
+    }
+    uint64_t fn, fn1;
+    fibonacci_pair_mod(n, m, &fn, &fn1);
+    return fn;
+}
+
+
+/*
+PISANO PERIODS
+F(n) mod m repeats with period pi(m) <= 6m, so F(n) mod m = F(n mod pi(m)) mod m.
+pi(m) is the lcm of pi(p^e) over the prime powers of m, with
+    pi(p^e) = p^(e-1) * pi(p),  pi(2) = 3,  pi(5) = 20,
+and pi(p) dividing p - 1 (p = +-1 mod 5) or 2(p + 1) (p = +-2 mod 5);
+the smallest divisor d of that bound with F(d) = 0, F(d+1) = 1 is pi(p).
+The result is verified the same way, and not used if the check fails.
+
+Periods are computed once per modulus (trial division, so only for
+m <= PISANO_MAX_MODULUS) and kept in a cache. When the period is short the
+whole cycle is stored too, and a query becomes one table lookup. All cycles
+of one cache share PISANO_TABLE_BUDGET bytes; once that is used up, new
+moduli keep only their period and use fast doubling on n mod pi(m).
+*/
+#define PISANO_MAX_MODULUS UINT32_MAX
+#define PISANO_TABLE_MAX (1u << 20)   // Store the cycle if pi(m) is at most this
+#define PISANO_TABLE_BUDGET (64u << 20)   // Bytes of cycles per cache
+
+static bool is_period(uint64_t d, uint64_t m) {
+    uint64_t fn, fn1;
+    fibonacci_pair_mod(d, m, &fn, &fn1);
+    return fn == 0 && fn1 == 1 % m;
+}
+
+static uint64_t gcd_u64(uint64_t a, uint64_t b) {
+    while (b) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// pi(p) for a prime p
+static uint64_t pisano_prime(uint64_t p) {
+    if (p == 2) return 3;
+    if (p == 5) return 20;
+    uint64_t d = (p % 5 == 1 || p % 5 == 4) ? p - 1 : 2 * (p + 1);
+
+    // Strip prime factors q of the bound while d / q is still a period
+    uint64_t rest = d;
+    for (uint64_t q = 2; q * q <= rest; q++) {
+        if (rest % q) continue;
+        while (rest % q == 0) rest /= q;
+        while (d % q == 0 && is_period(d / q, p)) d /= q;
+    }
+    if (rest > 1) {
+        while (d % rest == 0 && is_period(d / rest, p)) d /= rest;
+    }
+    return d;
+}
+
+// pi(m) for m <= PISANO_MAX_MODULUS, 0 if it cannot be determined
+uint64_t pisano_period(uint64_t m) {
+    if (m == 0 || m > PISANO_MAX_MODULUS) return 0;
+    if (m == 1) return 1;
+    uint64_t period = 1, rest = m;
+    for (uint64_t p = 2; p * p <= rest || rest > 1; p++) {
+        if (p * p > rest) p = rest;   // What is left is prime
+        if (rest % p) continue;
+        uint64_t pe = 1;
+        while (rest % p == 0) {
+            rest /= p;
+            pe *= p;
+        }
+        uint64_t local = pisano_prime(p) * (pe / p);
+        period = period / gcd_u64(period, local) * local;
+    }
+    return is_period(period, m) ? period : 0;
+}
+
+typedef struct {
+    uint64_t modulus;    // 0 marks an empty slot
+    uint64_t period;     // 0 if not known
+    uint32_t *cycle;     // F(0 .. period-1) mod m, or NULL
+} PisanoEntry;
+
+// Open-addressing hash table: modulus -> period (and cycle)
+typedef struct {
+    PisanoEntry *slots;
+    size_t capacity;     // Power of two
+    size_t count;
+    size_t table_bytes;  // Bytes held by cycles, at most PISANO_TABLE_BUDGET
+} PisanoCache;
 
-    printf("Fibonacci number at position %d is (binet): %lld\n", n, fibonacci_binet(n));
-}
\ No newline at end of file
+static size_t pisano_slot(const PisanoCache *cache, uint64_t m) {
+    size_t i = (size_t)((m * 0x9E3779B97F4A7C15ULL) >> 20) & (cache->capacity - 1);
+    while (cache->slots[i].modulus != 0 && cache->slots[i].modulus != m) {
+        i = (i + 1) & (cache->capacity - 1);
+    }
+    return i;
+}
+
+// Returns false if the slot array cannot be allocated
+bool pisano_cache_init(PisanoCache *cache) {
+    cache->capacity = 64;
+    cache->count = 0;
+    cache->table_bytes = 0;
+    cache->slots = calloc(cache->capacity, sizeof(PisanoEntry));
+    return cache->slots != NULL;
+}
+
+void pisano_cache_free(PisanoCache *cache) {
+    for (size_t i = 0; i < cache->capacity; i++) free(cache->slots[i].cycle);
+    free(cache->slots);
+    cache->slots = NULL;
+}
+
+// Read-only lookup (safe to share between threads once filled)
+const PisanoEntry *pisano_find(const PisanoCache *cache, uint64_t m) {
+    size_t i = pisano_slot(cache, m);
+    return cache->slots[i].modulus == m ? &cache->slots[i] : NULL;
+}
+
+/*
+Returns the entry for m, computing the period (and cycle) the first time.
+Returns NULL if the table cannot grow; the cache is left as it was, and
+lookups of m then miss, which only costs the fallback to fibonacci_mod.
+*/
+const PisanoEntry *pisano_get(PisanoCache *cache, uint64_t m) {
+    size_t i = pisano_slot(cache, m);
+    if (cache->slots[i].modulus == m) return &cache->slots[i];
+
+    if (2 * (cache->count + 1) > cache->capacity) {
+        // Grow and rehash
+        PisanoCache bigger = {calloc(cache->capacity * 2, sizeof(PisanoEntry)), cache->capacity * 2, cache->count,
+                              cache->table_bytes};
+        if (!bigger.slots) return NULL;
+        for (size_t k = 0; k < cache->capacity; k++) {
+            if (cache->slots[k].modulus) bigger.slots[pisano_slot(&bigger, cache->slots[k].modulus)] = cache->slots[k];
+        }
+        free(cache->slots);
+        *cache = bigger;
+        i = pisano_slot(cache, m);
+    }
+
+    PisanoEntry *e = &cache->slots[i];
+    e->modulus = m;
+    e->period = pisano_period(m);
+    e->cycle = NULL;
+    size_t bytes = (size_t)e->period * sizeof(uint32_t);
+    if (e->period > 0 && e->period <= PISANO_TABLE_MAX && cache->table_bytes + bytes <= PISANO_TABLE_BUDGET) {
+        e->cycle = malloc(bytes);
+        if (e->cycle) {
+            cache->table_bytes += bytes;
+            uint64_t a = 0, b = 1 % m;
+            for (uint64_t k = 0; k < e->period; k++) {
+                e->cycle[k] = (uint32_t)a;
+                uint64_t c = add_mod(a, b, m);
+                a = b;
+                b = c;
+            }
+        }
+    }
+    cache->count++;
+    return e;
+}
+
+// F(n) mod m using a cache entry: cycle lookup, else n reduced mod pi(m)
+static uint64_t fibonacci_mod_entry(const PisanoEntry *e, uint64_t n, uint64_t m) {
+    if (e && e->cycle) return e->cycle[n % e->period];
+    if (e && e->period) n %= e->period;
+    return fibonacci_mod(n, m);
+}
+
+
+/*
+BATCH QUERIES
+Queries are passed as separate arrays (n[], m[], out[]) rather than an
+array of structs, so each pass streams through contiguous memory. Each
+query still does its own hash lookup and a 64-bit n % period, so the loop
+is scalar; the saving over fibonacci_mod is skipping the O(log n) doubling.
+1. Single-threaded: fill the Pisano cache for every distinct modulus.
+2. The index range is split into equal chunks, one per thread; the threads
+   only read the cache, so no locking is needed.
+*/
+typedef struct {
+    const PisanoCache *cache;
+    const uint64_t *n, *m;
+    uint64_t *out;
+    size_t begin, end;
+} BatchChunk;
+
+static void *batch_worker(void *arg) {
+    BatchChunk *chunk = arg;
+    for (size_t i = chunk->begin; i < chunk->end; i++) {
+        uint64_t m = chunk->m[i];
+        chunk->out[i] = m ? fibonacci_mod_entry(pisano_find(chunk->cache, m), chunk->n[i], m) : 0;
+    }
+    return NULL;
+}
+
+// out[i] = F(n[i]) mod m[i] (m[i] = 0 gives 0)
+void fibonacci_mod_batch(PisanoCache *cache, const uint64_t *n, const uint64_t *m, uint64_t *out,
+                         size_t count, int threads) {
+    for (size_t i = 0; i < count; i++) {
+        if (m[i]) pisano_get(cache, m[i]);
+    }
+    if (threads < 1) threads = 1;
+    if ((size_t)threads > count) threads = count ? (int)count : 1;
+
+    pthread_t *ids = malloc((size_t)threads * sizeof(pthread_t));
+    BatchChunk *chunks = malloc((size_t)threads * sizeof(BatchChunk));
+    if (!ids || !chunks) {
+        // No room for the thread bookkeeping: run the whole range here
+        free(ids);
+        free(chunks);
+        BatchChunk all = {cache, n, m, out, 0, count};
+        batch_worker(&all);
+        return;
+    }
+    size_t per = (count + (size_t)threads - 1) / (size_t)threads;
+    for (int t = 0; t < threads; t++) {
+        size_t begin = (size_t)t * per < count ? (size_t)t * per : count;
+        size_t end = begin + per < count ? begin + per : count;
+        chunks[t] = (BatchChunk){cache, n, m, out, begin, end};
+    }
+    int started = 0;
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&ids[started], NULL, batch_worker, &chunks[t]) == 0) {
+            started++;
+        } else {
+            batch_worker(&chunks[t]);   // Could not start a thread: do its chunk here
+        }
+    }
+    batch_worker(&chunks[0]);
+    for (int t = 0; t < started; t++) pthread_join(ids[t], NULL);
+    free(ids);
+    free(chunks);
+}
+
+// Reads "n m" pairs from a file ("-" for stdin) and prints F(n) mod m for each
+int run_batch_file(const char *filename, int threads) {
+    FILE *in = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+    if (!in) {
+        printf("Could not open %s\n", filename);
+        return 1;
+    }
+    size_t cap = 1024, count = 0;
+    uint64_t *n = malloc(cap * sizeof(uint64_t)), *m = malloc(cap * sizeof(uint64_t)), *out = NULL;
+    bool ok = n && m;
+    unsigned long long qn, qm;
+    while (ok && fscanf(in, "%llu %llu", &qn, &qm) == 2) {
+        if (count == cap) {
+            cap *= 2;
+            uint64_t *grown_n = realloc(n, cap * sizeof(uint64_t));
+            if (grown_n) n = grown_n;
+            uint64_t *grown_m = grown_n ? realloc(m, cap * sizeof(uint64_t)) : NULL;
+            if (grown_m) m = grown_m;
+            ok = grown_n && grown_m;
+            if (!ok) break;
+        }
+        n[count] = qn;
+        m[count++] = qm;
+    }
+    if (in != stdin) fclose(in);
+    if (ok) {
+        out = malloc((count ? count : 1) * sizeof(uint64_t));
+        ok = out != NULL;
+    }
+    PisanoCache cache;
+    if (!ok || !pisano_cache_init(&cache)) {
+        printf("Out of memory.\n");
+        free(n);
+        free(m);
+        free(out);
+        return 1;
+    }
+    fibonacci_mod_batch(&cache, n, m, out, count, threads);
+    static char buffer[1 << 20];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    for (size_t i = 0; i < count; i++) printf("%llu\n", (unsigned long long)out[i]);
+    fflush(stdout);
+
+    pisano_cache_free(&cache);
+    free(n);
+    free(m);
+    free(out);
+    return 0;
+}
+
+
+/*
+LINEAR RECURRENCES
+Fibonacci is the k = 2 case of
+    a(n) = c[0]*a(n-1) + c[1]*a(n-2) + ... + c[k-1]*a(n-k)
+with given a(0) .. a(k-1) (tribonacci: k = 3, c = {1,1,1}; path counts and
+DP transitions have the same shape).
+
+Kitamasa's method: with P(x) = x^k - c[0]x^(k-1) - ... - c[k-1], write
+x^n mod P(x) = r[0] + r[1]x + ... + r[k-1]x^(k-1); then
+    a(n) = r[0]*a(0) + ... + r[k-1]*a(k-1).
+x^n mod P is built from the top bit of n down: square (O(k^2) product plus
+reduction with x^k = c[0]x^(k-1) + ... + c[k-1]), and multiply by x for a
+set bit (a shift plus one O(k) reduction step).
+
+TIME COMPLEXITY: O(k^2 log n)     SPACE COMPLEXITY: O(k)
+
+Variants:
+- linrec_mod: a(n) mod m.
+- linrec_wrap64: the same arithmetic mod 2^64 (wrapping unsigned math). This is
+  a ring homomorphism, so the result is the exact value whenever that value
+  fits in 64 bits (read it as int64_t for signed sequences).
+- linrec_checked: exact int64 with every product and sum overflow-checked;
+  fails instead of wrapping. Up to LINREC_DIRECT_MAX it iterates directly
+  (fails only if some a(i), i <= n, overflows); beyond that it runs the same
+  O(k^2 log n) doubling, which also fails if a coefficient of x^n mod P
+  does not fit.
+For k <= 4 the dispatchers use kernels compiled with k as a constant, so the
+polynomial loops are fully unrolled.
+*/
+#define LINREC_MAX_K 64
+#define LINREC_DIRECT_MAX 4096   // linrec_checked iterates directly up to this n
+
+// Arithmetic for the polynomial steps: mod m, or mod 2^64 when m == 0
+static inline uint64_t lr_mul(uint64_t a, uint64_t b, uint64_t m) {
+    return m ? (uint64_t)((u128)a * b % m) : a * b;
+}
+
+static inline uint64_t lr_add(uint64_t a, uint64_t b, uint64_t m) {
+    return m ? add_mod(a, b, m) : a + b;
+}
+
+// r = r * r mod P(x)
+static inline __attribute__((always_inline)) void
+lr_square(int k, uint64_t *r, const uint64_t *c, uint64_t m) {
+    uint64_t t[2 * LINREC_MAX_K];
+    for (int i = 0; i < 2 * k - 1; i++) t[i] = 0;
+    for (int i = 0; i < k; i++)
+        for (int j = 0; j < k; j++) t[i + j] = lr_add(t[i + j], lr_mul(r[i], r[j], m), m);
+    // Fold x^i (i >= k) back: x^i = sum c[j] x^(i-1-j)
+    for (int i = 2 * k - 2; i >= k; i--)
+        for (int j = 0; j < k; j++) t[i - 1 - j] = lr_add(t[i - 1 - j], lr_mul(t[i], c[j], m), m);
+    for (int i = 0; i < k; i++) r[i] = t[i];
+}
+
+// r = r * x mod P(x)
+static inline __attribute__((always_inline)) void
+lr_times_x(int k, uint64_t *r, const uint64_t *c, uint64_t m) {
+    uint64_t top = r[k - 1];
+    for (int i = k - 1; i > 0; i--) r[i] = lr_add(r[i - 1], lr_mul(top, c[k - 1 - i], m), m);
+    r[0] = lr_mul(top, c[k - 1], m);
+}
+
+// a(n) with coefficients and initial terms already reduced (mod m, or mod 2^64 if m == 0)
+static inline __attribute__((always_inline)) uint64_t
+lr_kernel(int k, const uint64_t *c, const uint64_t *init, uint64_t n, uint64_t m) {
+    if (n < (uint64_t)k) return init[n];
+    uint64_t r[LINREC_MAX_K];
+    for (int i = 0; i < k; i++) r[i] = 0;
+    r[0] = m == 1 ? 0 : 1;   // x^0
+    for (int bit = 63 - __builtin_clzll(n); bit >= 0; bit--) {
+        lr_square(k, r, c, m);
+        if ((n >> bit) & 1) lr_times_x(k, r, c, m);
+    }
+    uint64_t a = 0;
+    for (int i = 0; i < k; i++) a = lr_add(a, lr_mul(r[i], init[i], m), m);
+    return a;
+}
+
+// Kernels with k fixed at compile time
+#define DEFINE_LINREC_KERNEL(K) \
+    static uint64_t linrec_kernel_##K(const uint64_t *c, const uint64_t *init, uint64_t n, uint64_t m) { \
+        return lr_kernel(K, c, init, n, m); \
+    }
+DEFINE_LINREC_KERNEL(1)
+DEFINE_LINREC_KERNEL(2)
+DEFINE_LINREC_KERNEL(3)
+DEFINE_LINREC_KERNEL(4)
+
+static uint64_t linrec_kernel_generic(int k, const uint64_t *c, const uint64_t *init, uint64_t n, uint64_t m) {
+    return lr_kernel(k, c, init, n, m);
+}
+
+static uint64_t linrec_dispatch(int k, const uint64_t *c, const uint64_t *init, uint64_t n, uint64_t m) {
+    switch (k) {
+        case 1: return linrec_kernel_1(c, init, n, m);
+        case 2: return linrec_kernel_2(c, init, n, m);
+        case 3: return linrec_kernel_3(c, init, n, m);
+        case 4: return linrec_kernel_4(c, init, n, m);
+        default: return linrec_kernel_generic(k, c, init, n, m);
+    }
+}
+
+// a(n) mod m (m >= 1, 1 <= k <= LINREC_MAX_K); negative values are taken mod m
+uint64_t linrec_mod(int k, const int64_t *coef, const int64_t *init, uint64_t n, uint64_t m) {
+    uint64_t c[LINREC_MAX_K], a0[LINREC_MAX_K];
+    for (int i = 0; i < k; i++) {
+        c[i] = coef[i] < 0 ? (m - (uint64_t)(-(coef[i] + 1)) % m - 1) % m : (uint64_t)coef[i] % m;
+        a0[i] = init[i] < 0 ? (m - (uint64_t)(-(init[i] + 1)) % m - 1) % m : (uint64_t)init[i] % m;
+    }
+    return linrec_dispatch(k, c, a0, n, m);
+}
+
+// a(n) mod 2^64: the exact value whenever it fits in 64 bits
+uint64_t linrec_wrap64(int k, const int64_t *coef, const int64_t *init, uint64_t n) {
+    uint64_t c[LINREC_MAX_K], a0[LINREC_MAX_K];
+    for (int i = 0; i < k; i++) {
+        c[i] = (uint64_t)coef[i];
+        a0[i] = (uint64_t)init[i];
+    }
+    return linrec_dispatch(k, c, a0, n, 0);
+}
+
+// t += a * b, false on int64 overflow
+static inline bool lr_fma_checked(int64_t *t, int64_t a, int64_t b) {
+    int64_t prod;
+    return !__builtin_mul_overflow(a, b, &prod) && !__builtin_add_overflow(*t, prod, t);
+}
+
+// r = r * s mod P(x) (s == NULL: r = r * x) over int64, false on overflow
+static bool lr_mulmod_checked(int k, int64_t *r, const int64_t *s, const int64_t *coef) {
+    int64_t t[2 * LINREC_MAX_K] = {0};
+    int top;
+    if (s) {
+        for (int i = 0; i < k; i++)
+            for (int j = 0; j < k; j++)
+                if (!lr_fma_checked(&t[i + j], r[i], s[j])) return false;
+        top = 2 * k - 2;
+    } else {
+        for (int i = 0; i < k; i++) t[i + 1] = r[i];
+        top = k;
+    }
+    for (int i = top; i >= k; i--)
+        for (int j = 0; j < k; j++)
+            if (!lr_fma_checked(&t[i - 1 - j], t[i], coef[j])) return false;
+    memcpy(r, t, (size_t)k * sizeof(int64_t));
+    return true;
+}
+
+// Exact a(n), false if it (or an intermediate value, see above) overflows int64
+bool linrec_checked(int k, const int64_t *coef, const int64_t *init, uint64_t n, int64_t *out) {
+    if (n < (uint64_t)k) {
+        *out = init[n];
+        return true;
+    }
+    if (n > LINREC_DIRECT_MAX) {
+        // x^n mod P(x), from the top bit of n down
+        int64_t r[LINREC_MAX_K] = {0};
+        r[0] = 1;
+        for (int bit = 63 - __builtin_clzll(n); bit >= 0; bit--) {
+            int64_t sq[LINREC_MAX_K];
+            memcpy(sq, r, (size_t)k * sizeof(int64_t));
+            if (!lr_mulmod_checked(k, r, sq, coef)) return false;
+            if (((n >> bit) & 1) && !lr_mulmod_checked(k, r, NULL, coef)) return false;
+        }
+        int64_t sum = 0;
+        for (int i = 0; i < k; i++)
+            if (!lr_fma_checked(&sum, r[i], init[i])) return false;
+        *out = sum;
+        return true;
+    }
+    int64_t window[LINREC_MAX_K];   // Ring buffer of the last k terms
+    memcpy(window, init, (size_t)k * sizeof(int64_t));
+    int64_t next = 0;
+    for (uint64_t i = (uint64_t)k; i <= n; i++) {
+        next = 0;
+        for (int j = 0; j < k; j++) {
+            int64_t prod;
+            int64_t prev = window[(i - 1 - (uint64_t)j) % (uint64_t)k];
+            if (__builtin_mul_overflow(coef[j], prev, &prod) || __builtin_add_overflow(next, prod, &next)) {
+                return false;
+            }
+        }
+        window[i % (uint64_t)k] = next;
+    }
+    *out = next;
+    return true;
+}
+
+// Parses "1,2,3" into at most max integers, returns the count (0 on error)
+static int parse_list(const char *text, int64_t *values, int max) {
+    int count = 0;
+    char *end;
+    while (*text && count < max) {
+        values[count++] = strtoll(text, &end, 10);
+        if (end == text) return 0;
+        text = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') return 0;
+    }
+    return *text ? 0 : count;
+}
+
+
+/*
+BENCHMARK
+Times every method on the same inputs and checks them against each other:
+- 64-bit: iterative O(n), Binet O(1) (reports the first n where it is wrong),
+  fast doubling O(log n), all for n = 0..92
+- big integers: fast doubling with Karatsuba vs. the O(n) addition loop
+*/
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// O(n) big-integer loop used as the baseline in the benchmark
+static bool fibonacci_big_iterative(unsigned long long n, BigInt *out) {
+    BigInt a, b;
+    bool ok = big_from_u32(0, &a) & big_from_u32(1, &b);
+    for (unsigned long long i = 0; ok && i < n; i++) {
+        BigInt c;
+        ok = big_add(&a, &b, &c);
+        big_free(&a);
+        a = b;
+        b = c;
+    }
+    big_free(&b);
+    if (!ok) {
+        big_free(&a);
+        return false;
+    }
+    *out = a;
+    return true;
+}
+
+void run_benchmark(void) {
+    const int rounds = 200000;
+    volatile uint64_t sink = 0;
+    double t0, t1;
+
+    int binet_first_wrong = -1;
+    for (int n = 0; n <= 92; n++) {
+        uint64_t exact;
+        fibonacci_u64(n, &exact);
+        if ((uint64_t)fibonacci(n) != exact) {
+            printf("Mismatch: iterative F(%d)\n", n);
+        }
+        if (binet_first_wrong < 0 && (uint64_t)fibonacci_binet(n) != exact) {
+            binet_first_wrong = n;
+        }
+    }
+
+    printf("64-bit methods, n = 0..92, %d rounds:\n", rounds);
+    t0 = now_seconds();
+    for (int r = 0; r < rounds; r++)
+        for (int n = 0; n <= 92; n++) sink += (uint64_t)fibonacci(n);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/call\n", "iterative", (t1 - t0) * 1e9 / (rounds * 93.0));
+
+    t0 = now_seconds();
+    for (int r = 0; r < rounds; r++)
+        for (int n = 0; n <= 92; n++) sink += (uint64_t)fibonacci_binet(n);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/call  (first wrong at n = %d)\n", "binet", (t1 - t0) * 1e9 / (rounds * 93.0), binet_first_wrong);
+
+    t0 = now_seconds();
+    for (int r = 0; r < rounds; r++)
+        for (int n = 0; n <= 92; n++) {
+            uint64_t v;
+            fibonacci_u64(n, &v);
+            sink += v;
+        }
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/call\n", "fast doubling u64", (t1 - t0) * 1e9 / (rounds * 93.0));
+
+    t0 = now_seconds();
+    for (int r = 0; r < rounds; r++)
+        for (int n = 0; n <= 92; n++) {
+            u128 v;
+            fibonacci_u128(n, &v);
+            sink += (uint64_t)v;
+        }
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/call\n", "fast doubling u128", (t1 - t0) * 1e9 / (rounds * 93.0));
+
+    printf("Big integers:\n");
+    unsigned long long sizes[] = {1000, 10000, 100000, 1000000};
+    for (int i = 0; i < 4; i++) {
+        unsigned long long n = sizes[i];
+        BigInt fast, slow;
+        t0 = now_seconds();
+        if (!fibonacci_big(n, &fast)) {
+            printf("  F(%llu): out of memory\n", n);
+            continue;
+        }
+        t1 = now_seconds();
+        printf("  F(%llu): %zu digits, fast doubling %.4f s", n, big_digits(&fast), t1 - t0);
+        if (n <= 100000) {
+            t0 = now_seconds();
+            bool done = fibonacci_big_iterative(n, &slow);
+            t1 = now_seconds();
+            if (done) {
+                bool same = slow.len == fast.len && memcmp(slow.limb, fast.limb, fast.len * sizeof(uint32_t)) == 0;
+                printf(", iterative %.4f s%s", t1 - t0, same ? "" : "  MISMATCH");
+                big_free(&slow);
+            } else {
+                printf(", iterative: out of memory");
+            }
+        }
+        printf("\n");
+        big_free(&fast);
+    }
+
+    // Modular batch: 1,000,000 queries over 1000 moduli, with and without the Pisano cache
+    const size_t queries = 1000000;
+    uint64_t *qn = malloc(queries * sizeof(uint64_t)), *qm = malloc(queries * sizeof(uint64_t));
+    uint64_t *o1 = malloc(queries * sizeof(uint64_t)), *o2 = malloc(queries * sizeof(uint64_t));
+    PisanoCache cache = {0};
+    if (!qn || !qm || !o1 || !o2 || !pisano_cache_init(&cache)) {
+        printf("Out of memory.\n");
+        free(cache.slots);
+        free(qn);
+        free(qm);
+        free(o1);
+        free(o2);
+        return;
+    }
+    uint64_t state = 12345;
+    for (size_t i = 0; i < queries; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        qn[i] = state;
+        qm[i] = 1000 + (state >> 40) % 1000 * 7919;   // 1000 distinct moduli
+    }
+    printf("Modular batch, %zu queries, 1000 moduli:\n", queries);
+    t0 = now_seconds();
+    for (size_t i = 0; i < queries; i++) o1[i] = fibonacci_mod(qn[i], qm[i]);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/query\n", "fast doubling (Barrett)", (t1 - t0) * 1e9 / queries);
+
+    t0 = now_seconds();
+    fibonacci_mod_batch(&cache, qn, qm, o2, queries, 1);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/query (incl. building the cache)%s\n", "Pisano cache batch", (t1 - t0) * 1e9 / queries,
+           memcmp(o1, o2, queries * sizeof(uint64_t)) == 0 ? "" : "  MISMATCH");
+    t0 = now_seconds();
+    fibonacci_mod_batch(&cache, qn, qm, o2, queries, 1);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/query (warm cache)\n", "Pisano cache batch", (t1 - t0) * 1e9 / queries);
+    pisano_cache_free(&cache);
+
+    // Linear recurrence engine: specialized k = 2, 3 kernels vs. the generic one
+    const int64_t fib_c[2] = {1, 1}, fib_a[2] = {0, 1};
+    const int64_t trib_c[3] = {1, 1, 1}, trib_a[3] = {0, 0, 1};
+    const uint64_t fib_cu[2] = {1, 1}, fib_au[2] = {0, 1};
+    const uint64_t trib_cu[3] = {1, 1, 1}, trib_au[3] = {0, 0, 1};
+    const uint64_t lr_mod = 1000000007;
+    const size_t lr_queries = 100000;
+    printf("Linear recurrences mod 1e9+7, %zu queries:\n", lr_queries);
+    t0 = now_seconds();
+    for (size_t i = 0; i < lr_queries; i++) sink += linrec_kernel_2(fib_cu, fib_au, qn[i], lr_mod);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/query\n", "k = 2 specialized", (t1 - t0) * 1e9 / lr_queries);
+    t0 = now_seconds();
+    for (size_t i = 0; i < lr_queries; i++) sink += linrec_kernel_generic(2, fib_cu, fib_au, qn[i], lr_mod);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/query\n", "k = 2 generic", (t1 - t0) * 1e9 / lr_queries);
+    t0 = now_seconds();
+    for (size_t i = 0; i < lr_queries; i++) sink += linrec_kernel_3(trib_cu, trib_au, qn[i], lr_mod);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/query\n", "k = 3 specialized", (t1 - t0) * 1e9 / lr_queries);
+    t0 = now_seconds();
+    for (size_t i = 0; i < lr_queries; i++) sink += linrec_kernel_generic(3, trib_cu, trib_au, qn[i], lr_mod);
+    t1 = now_seconds();
+    printf("  %-22s %8.1f ns/query\n", "k = 3 generic", (t1 - t0) * 1e9 / lr_queries);
+    bool lr_ok = true;
+    for (size_t i = 0; i < 1000; i++) {
+        lr_ok = lr_ok && linrec_mod(2, fib_c, fib_a, qn[i], lr_mod) == fibonacci_mod(qn[i], lr_mod);
+    }
+    int64_t trib;
+    lr_ok = lr_ok && linrec_checked(3, trib_c, trib_a, 37, &trib) && trib == 1132436852;
+    printf("  engine agrees with fibonacci_mod and tribonacci: %s\n", lr_ok ? "yes" : "NO");
+
+    free(qn);
+    free(qm);
+    free(o1);
+    free(o2);
+    (void)sink;
+}
+
+int main(int argc, char *argv[]){
+    long long n;
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        run_benchmark();
+        return 0;
+    }
+
+    // ./fibonacci --mod <m> <n>   and   ./fibonacci --batch <file> [threads]
+    if (argc > 3 && strcmp(argv[1], "--mod") == 0) {
+        uint64_t m = strtoull(argv[2], NULL, 10), q = strtoull(argv[3], NULL, 10);
+        if (m == 0) {
+            printf("The modulus must be positive.\n");
+            return 1;
+        }
+        PisanoCache cache;
+        if (!pisano_cache_init(&cache)) {
+            printf("Out of memory.\n");
+            return 1;
+        }
+        const PisanoEntry *e = pisano_get(&cache, m);
+        printf("F(%llu) mod %llu = %llu", (unsigned long long)q, (unsigned long long)m,
+               (unsigned long long)fibonacci_mod_entry(e, q, m));
+        if (e && e->period) printf("  (Pisano period %llu)", (unsigned long long)e->period);
+        printf("\n");
+        pisano_cache_free(&cache);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "--batch") == 0) {
+        return run_batch_file(argv[2], argc > 3 ? atoi(argv[3]) : 1);
+    }
+
+    // ./fibonacci --linrec <c1,..,ck> <a0,..,a(k-1)> <n> [m]
+    if (argc > 4 && strcmp(argv[1], "--linrec") == 0) {
+        int64_t coef[LINREC_MAX_K], init[LINREC_MAX_K];
+        int k = parse_list(argv[2], coef, LINREC_MAX_K);
+        if (k == 0 || parse_list(argv[3], init, LINREC_MAX_K) != k) {
+            printf("Give k coefficients and k initial terms (1 <= k <= %d), comma separated.\n", LINREC_MAX_K);
+            return 1;
+        }
+        uint64_t q = strtoull(argv[4], NULL, 10);
+        if (argc > 5) {
+            uint64_t m = strtoull(argv[5], NULL, 10);
+            if (m == 0) {
+                printf("The modulus must be positive.\n");
+                return 1;
+            }
+            printf("a(%llu) mod %llu = %llu\n", (unsigned long long)q, (unsigned long long)m,
+                   (unsigned long long)linrec_mod(k, coef, init, q, m));
+            return 0;
+        }
+        int64_t exact;
+        if (linrec_checked(k, coef, init, q, &exact)) {
+            printf("a(%llu) = %lld\n", (unsigned long long)q, (long long)exact);
+        } else {
+            printf("a(%llu) does not fit 64-bit checked arithmetic; mod 2^64 it is %llu\n", (unsigned long long)q,
+                   (unsigned long long)linrec_wrap64(k, coef, init, q));
+        }
+        return 0;
+    }
+
+    if (argc > 1) {
+        n = atoll(argv[1]);
+    } else {
+        printf("Enter the position in Fibonacci series: ");
+        if (scanf("%lld", &n) != 1) {
+            printf("Invalid input.\n");
+            return 1;
+        }
+    }
+    if (n < 0) {
+        printf("Position cannot be negative.\n");
+        return 1;
+    }
+
+    // Exact result: 64-bit, then 128-bit, then big integers
+    uint64_t v64;
+    u128 v128;
+    printf("Fibonacci number at position %lld is: ", n);
+    if (fibonacci_u64(n, &v64)) {
+        printf("%llu\n", (unsigned long long)v64);
+    } else if (fibonacci_u128(n, &v128)) {
+        print_u128(v128);
+        printf("\n");
+    } else {
+        BigInt f;
+        if (!fibonacci_big(n, &f)) {
+            printf("out of memory\n");
+            return 1;
+        }
+        big_print(&f);
+        printf("\n(%zu digits)\n", big_digits(&f));
+        big_free(&f);
+    }
+
+    if (n <= 92) {
+        printf("Fibonacci number at position %lld is (binet, approximate): %lld\n", n, fibonacci_binet(n));
+    }
+    return 0;
+}
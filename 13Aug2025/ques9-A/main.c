@@ -1,76 +1,1326 @@
 /*
 TIME COMPLEXITY ANALYSIS:
+- calculate_power_double: O(1) for fractional exponents (one pow_kernel or sqrt/cbrt),
+  O(log exponent) for integer valued exponents.
+- Integer powers (calculate_power_int, power_i64, power_u64, power_i128):
+  O(log exponent) multiplications, exponentiation by squaring.
+- powmod: O(log exponent) Montgomery multiplications.
+- power_batch_f64 / power_batch_f32: O(n) work split over the threads, 4 or 8
+  elements per vector step.
 
 SPACE COMPLEXITY ANALYSIS:
+- O(1) for every function.
+
+None of the compute functions print anything. They report problems through
+their return value (PowerStatus) and main prints the diagnostics, so they
+can be called in a loop.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <float.h>
+#include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+typedef __int128 i128;
+typedef unsigned __int128 u128;
 
 // This creates a generic function macro, that will resolve to the appropriate function 
 // based on the type of the arguments passed during compile time.
+// A floating base with an integer typed exponent takes the exact integer exponent path,
+// and a constant integer valued exponent in [-POWER_CHAIN_MAX, POWER_CHAIN_MAX] is
+// expanded inline into its multiplication chain (see power_chain).
 #define calculate_power(base, exponent) _Generic((base) + (exponent), \
-    int: calculate_power_int, \
-    default: calculate_power_double \
-)(base, exponent)
+    int: calculate_power_int((base), (exponent)), \
+    long: calculate_power_i64((base), (exponent)), \
+    long long: calculate_power_i64((base), (exponent)), \
+    default: POWER_IS_CHAIN_CONSTANT(exponent) \
+        ? power_chain((base), (int)(exponent)) \
+        : _Generic((exponent), \
+            int: calculate_power_double_int, \
+            long: calculate_power_double_int, \
+            long long: calculate_power_double_int, \
+            default: calculate_power_double)((base), (exponent)) \
+)
+
+#define POWER_CHAIN_MAX 32
+
+// True only for an exponent the compiler can see: a literal or a folded constant
+#define POWER_IS_CHAIN_CONSTANT(exponent) \
+    (__builtin_constant_p(exponent) && (exponent) >= -POWER_CHAIN_MAX && \
+     (exponent) <= POWER_CHAIN_MAX && (exponent) == (int)(exponent))
+
+// Outcome of an integer power
+typedef enum {
+    POWER_OK = 0,
+    POWER_OVERFLOW,      // The exact result does not fit in the type
+    POWER_DIV_BY_ZERO    // 0 raised to a negative exponent
+} PowerStatus;
+
+// What to store in *out when the result overflows
+typedef enum {
+    POWER_CHECKED,       // Leave 0 in *out; only the status reports the overflow
+    POWER_SATURATING     // Clamp to the largest / smallest value of the type
+} OverflowMode;
+
+/*
+FLOATING POINT POWER
+calculate_power_double looks at the exponent before doing any work:
+- integer valued exponents (including negative ones, so (-2.0)^3.0 = -8)
+  go through calculate_power_double_int,
+- 0.5, -0.5, 0.25 and 1/3 use sqrt / cbrt for base >= 0,
+- everything else with a finite positive base uses pow_kernel,
+- zeros, infinities, NaNs and negative bases with a fractional exponent are
+  left to pow(), which already gets the IEEE special cases right.
+*/
+
+// Double-double number: value = hi + lo with |lo| <= ulp(hi) / 2
+typedef struct {
+    double hi;
+    double lo;
+} DoubleDouble;
+
+// (a.hi + a.lo) * (b.hi + b.lo), the hi*hi product is exact thanks to fma
+static inline DoubleDouble dd_mul(DoubleDouble a, DoubleDouble b) {
+    double p = a.hi * b.hi;
+    if (!isfinite(p) || p == 0) return (DoubleDouble){p, 0};
+    double e = fma(a.hi, b.hi, -p) + (a.hi * b.lo + a.lo * b.hi);
+    double hi = p + e;
+    return (DoubleDouble){hi, e - (hi - p)};
+}
+
+/*
+POW KERNEL TABLES
+Both halves of pow_kernel use a 128 entry table so that the polynomials
+stay short. They are filled once at startup from long double logl / exp2l,
+which are accurate to about 2^-64 and leave plenty of margin for the
+double-double values stored here.
+- log: z in [sqrt(1/2), sqrt(2)) is cut into 128 intervals by its top
+  mantissa bits. invc is 1/c for the interval centre c, rounded to 8
+  significant bits so that z * invc - 1 is exact, and logc = -ln(invc).
+- exp: exp2_table[j] = 2^(j/128).
+*/
+#define POW_TABLE_BITS 7
+#define POW_TABLE_SIZE (1 << POW_TABLE_BITS)
+#define LOG_OFF 0x3fe6955500000000ULL
+
+static struct {
+    double invc;
+    double logc_hi;
+    double logc_lo;
+} log_table[POW_TABLE_SIZE];
+
+static struct {
+    double hi;
+    double lo;
+} exp2_table[POW_TABLE_SIZE];
+
+static double as_double(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof d);
+    return d;
+}
+
+static uint64_t as_bits(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof bits);
+    return bits;
+}
+
+__attribute__((constructor))
+static void pow_tables_init(void) {
+    for (int i = 0; i < POW_TABLE_SIZE; i++) {
+        uint64_t lo_bits = LOG_OFF + ((uint64_t)i << (52 - POW_TABLE_BITS));
+        double c = as_double(lo_bits + (1ULL << (51 - POW_TABLE_BITS)));
+        double invc = 1.0 / c;
+        // 8 significant bits: multiples of 2^-7 above 1, of 2^-8 below
+        invc = invc >= 1.0 ? nearbyint(invc * 128) / 128 : nearbyint(invc * 256) / 256;
+        // The interval holding 1.0 gets invc = 1 exactly, so ln(x) near 1 has no table error
+        if (as_double(lo_bits) <= 1.0 && 1.0 < as_double(lo_bits + (1ULL << (52 - POW_TABLE_BITS)))) invc = 1.0;
+        long double logc = -logl((long double)invc);
+        log_table[i].invc = invc;
+        log_table[i].logc_hi = (double)logc;
+        log_table[i].logc_lo = (double)(logc - (long double)log_table[i].logc_hi);
+
+        long double t = exp2l((long double)i / POW_TABLE_SIZE);
+        exp2_table[i].hi = (double)t;
+        exp2_table[i].lo = (double)(t - (long double)exp2_table[i].hi);
+    }
+}
+
+// ln(2) split so that k * LN2_HI is exact for |k| < 2^21
+#define LN2_HI 6.93147180369123816490e-01
+#define LN2_LO 1.90821492927058770002e-10
+#define SHIFT 0x1.8p52            // adding it rounds to an integer held in the low mantissa bits
+
+/*
+- x^y for finite x > 0 and finite y, as exp(y * ln(x)) with ln(x) and the
+  product y * ln(x) kept in double-double.
+- ln: x = 2^k * z, ln(x) = k*ln(2) + ln(c) + log1p(r) with r = z/c - 1,
+  |r| < 2^-7, degree 8 polynomial.
+- exp: y*ln(x) = (n/128)*ln(2) + r with |r| <= ln(2)/256,
+  exp = 2^(n/128) * (1 + expm1(r)), degree 5 polynomial.
+- No libm calls: the rounding to n uses the SHIFT trick and 2^k is put
+  straight into the exponent bits.
+- Error: within 1 ulp over the whole range (the final rounding plus about
+  2^-63 * |y*ln(x)| from the double-double product; 0.60 ulp was the worst
+  seen over 2 million samples against powl). exp(y*log(x)) loses
+  about |y*ln(x)| / 2 ulp instead, hundreds of ulp near overflow, because
+  the rounding error of log(x) is multiplied by y.
+*/
+static inline __attribute__((always_inline)) double pow_kernel(double x, double y) {
+    uint64_t bits = as_bits(x);
+    int k = 0;
+    if (bits < 0x0010000000000000ULL) {           // subnormal: scale into the normal range
+        bits = as_bits(x * 0x1p52);
+        k = -52;
+    }
 
-// Function to calculate power for double values, using exp and log for better precision
+    // x = 2^k * z, z in [OFF, 2 * OFF) with OFF about sqrt(1/2)
+    uint64_t t = bits - LOG_OFF;
+    int i = (int)((t >> (52 - POW_TABLE_BITS)) % POW_TABLE_SIZE);
+    k += (int)((int64_t)t >> 52);
+    double z = as_double(bits - (t & (0xfffULL << 52)));
+    double r = fma(z, log_table[i].invc, -1.0);    // exact
+
+    // ln(x) = hi + lo
+    double kd = (double)k;
+    double t1 = kd * LN2_HI + log_table[i].logc_hi;
+    double e1 = (kd * LN2_HI - t1) + log_table[i].logc_hi;   // |k*ln2| >= |logc| or k == 0
+    double hi = t1 + r;
+    double bb = hi - t1;
+    double e2 = (t1 - (hi - bb)) + (r - bb);                 // two-sum, no ordering assumed
+    double r2 = r * r;
+    double poly = r2 * (-1.0/2 + r * (1.0/3 + r * (-1.0/4 + r * (1.0/5 + r * (-1.0/6
+                + r * (1.0/7 + r * (-1.0/8)))))));
+    double lo = e1 + e2 + kd * LN2_LO + log_table[i].logc_lo + poly;
+    double sum = hi + lo;                                    // renormalize: poly is not small next to r
+    lo -= sum - hi;
+    hi = sum;
+
+    // y * ln(x) = zh + zl
+    double zh = y * hi;
+    if (zh > 709.8) return INFINITY;
+    if (zh < -745.2) return 0.0;
+    double zl = fma(y, hi, -zh) + y * lo;
+
+    // exp(zh + zl) = 2^(n/128) * exp(r)
+    double nd = zh * (POW_TABLE_SIZE / 0.69314718055994530942) + SHIFT;
+    uint64_t n = as_bits(nd);
+    nd -= SHIFT;
+    double rr = (zh - nd * (LN2_HI / POW_TABLE_SIZE)) - nd * (LN2_LO / POW_TABLE_SIZE) + zl;
+    double p = rr + rr * rr * (1.0/2 + rr * (1.0/6 + rr * (1.0/24 + rr * (1.0/120 + rr * (1.0/720)))));
+    int j = (int)(n % POW_TABLE_SIZE);
+    int e = (int)((int64_t)(n << 13) >> (13 + POW_TABLE_BITS));   // sign-extend the low 51 bits
+    double result = exp2_table[j].hi + (exp2_table[j].lo + exp2_table[j].hi * p);
+
+    if (e > -1022 && e < 1024) return result * as_double((uint64_t)(e + 1023) << 52);
+    return ldexp(result, e);
+}
+
+#define POWER_DD_MAX 8
+
+/*
+- base^exponent for an integer exponent.
+- |exponent| <= POWER_DD_MAX: squaring in double-double. Plain squaring in
+  double doubles the relative error at every step, which ends up around
+  exponent/2 ulp; with 106-bit intermediates the result is within 0.5 ulp.
+  Negative exponents raise 1/base (also kept as a double-double), so
+  2.0^-8 and friends stay exact.
+- Larger exponents: pow_kernel on |base| with the sign put back for odd
+  exponents. Each double-double step costs a few ns, so past 8 the kernel is
+  faster and still within 1 ulp (see ./main --bench).
+*/
+double calculate_power_double_int(double base, int64_t exponent) {
+    if (exponent == 0) return 1.0;
+    if (!isfinite(base) || base == 0) return pow(base, (double)exponent);
+    if (exponent > POWER_DD_MAX || exponent < -POWER_DD_MAX) {
+        double r = pow_kernel(fabs(base), (double)exponent);
+        return base < 0 && (exponent & 1) ? -r : r;
+    }
+
+    DoubleDouble b = {base, 0};
+    uint64_t e = exponent < 0 ? -(uint64_t)exponent : (uint64_t)exponent;
+    if (exponent < 0) {
+        double q = 1.0 / base;
+        b = (DoubleDouble){q, q * fma(-q, base, 1.0)};
+    }
+
+    DoubleDouble result = {1.0, 0};
+    while (e > 0) {
+        if (e & 1) result = dd_mul(result, b);
+        e >>= 1;
+        if (e > 0) b = dd_mul(b, b);
+    }
+    return result.hi + result.lo;
+}
+
+/*
+- libm's cbrt can be 1 ulp off (cbrt(27) is not 3 in glibc). One Newton step
+  with the residual y^3 - x computed through fma fixes that.
+*/
+static double cube_root(double x) {
+    double y = cbrt(x);
+    if (x == 0 || !isfinite(x)) return y + 0.0;
+    double y2 = y * y;
+    double y2_lo = fma(y, y, -y2);
+    double residual = fma(y2, y, -x) + y2_lo * y;
+    return y - residual / (3.0 * y2);
+}
+
+// 1/sqrt(x) rounds twice (up to 1 ulp); one Newton step on x*y^2 = 1 brings it back to 0.5 ulp
+static double inverse_sqrt(double x) {
+    double y = 1.0 / sqrt(x);
+    double y2 = y * y;
+    double t = fma(x, y2, -1.0) + x * fma(y, y, -y2);
+    return fma(-0.5 * y, t, y);
+}
+
+// Function to calculate power for double values
 double calculate_power_double(double base, double exponent) {
 
-    // e^( y * ln(x) ) = e^(ln(x^y)) = x^y
+    // Integer exponents work for any sign of base. Adding and removing SHIFT
+    // rounds to an integer only for |exponent| < 2^51 (the sum keeps a 1.0 ulp);
+    // [2^51, 2^52) still holds half-integers, and above 2^52 every double is one
+    if (exponent == 0) return 1.0;
+    double ae = fabs(exponent);
+    int integral = ae < 0x1p51 ? (exponent + SHIFT) - SHIFT == exponent
+                  : ae < 0x1p52 ? exponent == trunc(exponent)
+                  : ae <= 0x1p62;
+    if (integral) {
+        return calculate_power_double_int(base, (int64_t)exponent);
+    }
 
-    printf("Calculating power for doubles: %.2f^%.2f\n", base, exponent);
-    return exp(exponent * log(base));
+    // Roots; "+ 0.0" turns sqrt(-0.0) = -0.0 into +0.0 like pow does
+    if (base >= 0) {
+        if (exponent == 0.5) return sqrt(base) + 0.0;
+        if (exponent == 0.25) return sqrt(sqrt(base)) + 0.0;
+        if (exponent == 1.0 / 3.0) return cube_root(base);    // treated as an exact cube root
+        if (exponent == -0.5 && base > 0 && base < INFINITY) return inverse_sqrt(base);
+    }
+
+    // General case: e^( y * ln(x) ) = e^(ln(x^y)) = x^y
+    if (base > 0 && base < INFINITY && isfinite(exponent)) return pow_kernel(base, exponent);
+
+    // |y| > 2^62 is an even integer, so the sign of the base does not matter
+    if (base < 0 && isfinite(base) && isfinite(exponent)) {
+        return fabs(exponent) > 0x1p62 ? pow_kernel(-base, exponent) : NAN;
+    }
+    return pow(base, exponent);
 }
 
 /*
-- This function is better suited for integer calculations, using a more efficient method.
-- This only works for non-negative integer exponents.
-- This only works for small integer bases and exponents, as it does not handle large values that could overflow.
+CONSTANT EXPONENTS
+- power_chain computes x^n with a shortest addition chain for |n| <= 32,
+  e.g. x^15 = x^12 * x^3 from x^2, x^3, x^6, x^12 (5 multiplications where
+  binary squaring needs 6).
+- It is always inlined, so when calculate_power passes a constant n the
+  switch folds away and only the multiplications are left: no loop, no
+  branch, no call.
+- The products are plain doubles, so the error grows with the chain: at
+  most about (n-1)/2 ulp, usually 1 or 2. calculate_power_double_int keeps
+  0.5 ulp for any n at the cost of a loop. Negative n is 1 / x^|n|, which
+  gives 0 instead of a subnormal when x^|n| overflows.
 */
-int calculate_power_int(int base, int exponent) {
-    printf("Calculating power for integers: %d^%d\n", base, exponent);
-    
-    if (base == 0 && exponent == 0) {
-        return 1; // 0^0 is considered as 1 in many contexts
+static inline __attribute__((always_inline)) double power_chain_positive(double x, int n) {
+    double x2 = x * x, x3, x4, x5, x6, x7, x8, x10, x12, x14, x16, x20;
+    switch (n) {
+        case 0:  return 1.0;
+        case 1:  return x;
+        case 2:  return x2;
+        case 3:  return x2 * x;
+        case 4:  return x2 * x2;
+        case 5:  x4 = x2 * x2; return x4 * x;
+        case 6:  x3 = x2 * x; return x3 * x3;
+        case 7:  x3 = x2 * x; x5 = x3 * x2; return x5 * x2;
+        case 8:  x4 = x2 * x2; return x4 * x4;
+        case 9:  x4 = x2 * x2; x8 = x4 * x4; return x8 * x;
+        case 10: x4 = x2 * x2; x5 = x4 * x; return x5 * x5;
+        case 11: x4 = x2 * x2; x5 = x4 * x; x10 = x5 * x5; return x10 * x;
+        case 12: x3 = x2 * x; x6 = x3 * x3; return x6 * x6;
+        case 13: x4 = x2 * x2; x8 = x4 * x4; x12 = x8 * x4; return x12 * x;
+        case 14: x3 = x2 * x; x5 = x3 * x2; x7 = x5 * x2; return x7 * x7;
+        case 15: x3 = x2 * x; x6 = x3 * x3; x12 = x6 * x6; return x12 * x3;
+        case 16: x4 = x2 * x2; x8 = x4 * x4; return x8 * x8;
+        case 17: x4 = x2 * x2; x8 = x4 * x4; x16 = x8 * x8; return x16 * x;
+        case 18: x4 = x2 * x2; x8 = x4 * x4; x = x8 * x; return x * x;                     // (x^9)^2
+        case 19: x4 = x2 * x2; x8 = x4 * x4; x16 = x8 * x8; return x16 * x2 * x;
+        case 20: x4 = x2 * x2; x5 = x4 * x; x10 = x5 * x5; return x10 * x10;
+        case 21: x4 = x2 * x2; x5 = x4 * x; x10 = x5 * x5; x20 = x10 * x10; return x20 * x;
+        case 22: x4 = x2 * x2; x5 = x4 * x; x10 = x5 * x5; x = x10 * x; return x * x;      // (x^11)^2
+        case 23: x3 = x2 * x; x5 = x3 * x2; x10 = x5 * x5; x20 = x10 * x10; return x20 * x3;
+        case 24: x3 = x2 * x; x6 = x3 * x3; x12 = x6 * x6; return x12 * x12;
+        case 25: x3 = x2 * x; x5 = x3 * x2; x10 = x5 * x5; x20 = x10 * x10; return x20 * x5;
+        case 26: x4 = x2 * x2; x8 = x4 * x4; x12 = x8 * x4; x = x12 * x; return x * x;     // (x^13)^2
+        case 27: x3 = x2 * x; x6 = x3 * x3; x = x6 * x3; return x * x * x;                 // (x^9)^3
+        case 28: x3 = x2 * x; x5 = x3 * x2; x7 = x5 * x2; x14 = x7 * x7; return x14 * x14;
+        case 29: x3 = x2 * x; x5 = x3 * x2; x7 = x5 * x2; x14 = x7 * x7; return x14 * x14 * x;
+        case 30: x3 = x2 * x; x6 = x3 * x3; x12 = x6 * x6; x = x12 * x3; return x * x;     // (x^15)^2
+        case 31: x3 = x2 * x; x5 = x3 * x2; x10 = x5 * x5; x20 = x10 * x10; return x20 * x10 * x;
+        case 32: x4 = x2 * x2; x8 = x4 * x4; x16 = x8 * x8; return x16 * x16;
+    }
+    return calculate_power_double_int(x, n);
+}
+
+static inline __attribute__((always_inline)) double power_chain(double x, int n) {
+    return n < 0 ? 1.0 / power_chain_positive(x, -n) : power_chain_positive(x, n);
+}
+
+/*
+- Signed 64-bit exponentiation by squaring.
+- The base is only squared while more exponent bits remain, so a square that
+  overflows always means the final result overflows too.
+- Negative exponents follow integer division: 1 and -1 stay exact, 0 is a
+  division by zero, any other base truncates to 0.
+*/
+PowerStatus power_i64(int64_t base, int64_t exponent, OverflowMode mode, int64_t *out) {
+    *out = 0;
+    if (exponent < 0) {
+        if (base == 0) return POWER_DIV_BY_ZERO;
+        if (base == 1) *out = 1;
+        if (base == -1) *out = (exponent % 2 == 0) ? 1 : -1;
+        return POWER_OK;
+    }
+
+    int64_t result = 1;
+    int negative = base < 0 && (exponent & 1);
+    uint64_t e = (uint64_t)exponent;
+    while (e > 0) {
+        if ((e & 1) && __builtin_mul_overflow(result, base, &result)) break;
+        e >>= 1;
+        if (e > 0 && __builtin_mul_overflow(base, base, &base)) break;
+    }
+    if (e == 0) {
+        *out = result;
+        return POWER_OK;
+    }
+    if (mode == POWER_SATURATING) {
+        // Negative only for a negative base with an odd exponent
+        *out = negative ? INT64_MIN : INT64_MAX;
+    }
+    return POWER_OVERFLOW;
+}
+
+// Unsigned 64-bit exponentiation by squaring (same scheme as power_i64)
+PowerStatus power_u64(uint64_t base, uint64_t exponent, OverflowMode mode, uint64_t *out) {
+    uint64_t result = 1;
+    uint64_t e = exponent;
+    *out = 0;
+    while (e > 0) {
+        if ((e & 1) && __builtin_mul_overflow(result, base, &result)) break;
+        e >>= 1;
+        if (e > 0 && __builtin_mul_overflow(base, base, &base)) break;
+    }
+    if (e == 0) {
+        *out = result;
+        return POWER_OK;
     }
+    if (mode == POWER_SATURATING) *out = UINT64_MAX;
+    return POWER_OVERFLOW;
+}
+
+// Signed 128-bit exponentiation by squaring (same rules as power_i64)
+PowerStatus power_i128(i128 base, int64_t exponent, OverflowMode mode, i128 *out) {
+    const i128 max = (i128)(~(u128)0 >> 1);
+    *out = 0;
     if (exponent < 0) {
-        return 0; // Negative exponent for integers is not handled
+        if (base == 0) return POWER_DIV_BY_ZERO;
+        if (base == 1) *out = 1;
+        if (base == -1) *out = (exponent % 2 == 0) ? 1 : -1;
+        return POWER_OK;
     }
-    if (exponent == 0) {
-        return 1; // Any number to the power of 0 is 1
+
+    i128 result = 1;
+    int negative = base < 0 && (exponent & 1);
+    uint64_t e = (uint64_t)exponent;
+    while (e > 0) {
+        if ((e & 1) && __builtin_mul_overflow(result, base, &result)) break;
+        e >>= 1;
+        if (e > 0 && __builtin_mul_overflow(base, base, &base)) break;
+    }
+    if (e == 0) {
+        *out = result;
+        return POWER_OK;
     }
-    
-    int result = 1;
+    if (mode == POWER_SATURATING) {
+        *out = negative ? -max - 1 : max;
+    }
+    return POWER_OVERFLOW;
+}
+
+/*
+- This function is better suited for integer calculations, using a more efficient method.
+- Results that do not fit in an int are clamped to INT_MAX / INT_MIN; use
+  power_i64 directly to find out whether that happened.
+- Negative exponents truncate like integer division (0 for |base| > 1, and 0^-n gives 0).
+*/
+int calculate_power_int(int base, int exponent) {
+    int64_t result;
+    power_i64(base, exponent, POWER_SATURATING, &result);
+    if (result > INT_MAX) return INT_MAX;
+    if (result < INT_MIN) return INT_MIN;
+    return (int)result;
+}
+
+// 64-bit version used by calculate_power for long / long long arguments (saturating)
+int64_t calculate_power_i64(int64_t base, int64_t exponent) {
+    int64_t result;
+    power_i64(base, exponent, POWER_SATURATING, &result);
+    return result;
+}
+
+/*
+MODULAR POWER
+base^exponent mod m for any 64-bit modulus m >= 1.
+For odd m, Montgomery multiplication keeps numbers as a * 2^64 mod m and
+replaces the 128-bit division of every product by two multiplications
+(REDC). Even moduli use a plain 128-bit %.
+*/
+typedef struct {
+    uint64_t m;
+    uint64_t minv;    // m^-1 mod 2^64
+    uint64_t r2;      // 2^128 mod m
+} Montgomery;
+
+static Montgomery montgomery_init(uint64_t m) {
+    Montgomery mg = {m, m, 0};
+    for (int i = 0; i < 6; i++) mg.minv *= 2 - m * mg.minv;   // Newton: doubles the correct bits
+    uint64_t r = (0 - m) % m;                                 // 2^64 mod m
+    mg.r2 = (uint64_t)((u128)r * r % m);
+    return mg;
+}
+
+// t * 2^-64 mod m, for t < m * 2^64
+static inline uint64_t redc(const Montgomery *mg, u128 t) {
+    uint64_t q = (uint64_t)t * mg->minv;
+    uint64_t qm_hi = (uint64_t)(((u128)q * mg->m) >> 64);
+    uint64_t t_hi = (uint64_t)(t >> 64);
+    return t_hi >= qm_hi ? t_hi - qm_hi : t_hi - qm_hi + mg->m;
+}
+
+uint64_t powmod(uint64_t base, uint64_t exponent, uint64_t m) {
+    if (m == 1) return 0;
+    if ((m & 1) == 0) {
+        uint64_t result = 1, b = base % m;
+        while (exponent > 0) {
+            if (exponent & 1) result = (uint64_t)((u128)result * b % m);
+            exponent >>= 1;
+            if (exponent > 0) b = (uint64_t)((u128)b * b % m);
+        }
+        return result;
+    }
+
+    Montgomery mg = montgomery_init(m);
+    uint64_t result = redc(&mg, mg.r2);                       // 1 in Montgomery form
+    uint64_t b = redc(&mg, (u128)(base % m) * mg.r2);
     while (exponent > 0) {
-        if (exponent % 2 == 1) {
-            result *= base; // If exponent is odd, multiply by base
-            exponent = (exponent - 1) / 2; // Reduce exponent by 1 and divide by 2
+        if (exponent & 1) result = redc(&mg, (u128)result * b);
+        exponent >>= 1;
+        if (exponent > 0) b = redc(&mg, (u128)b * b);
+    }
+    return redc(&mg, result);
+}
+
+/*
+BATCH POWER
+power_batch_f64 / power_batch_f32 compute out[i] = x[i]^y[i], or
+x[i]^y_scalar when y is NULL, for whole arrays.
+- The vector kernels run the pow_kernel algorithm on 4 (AVX2) or 8
+  (AVX-512) lanes, with the tables read through gathers. The instruction set
+  is picked once at startup from what the CPU supports, and the scalar
+  fallback is calculate_power_double itself.
+- Lanes the vector code does not handle (base <= 0 or subnormal, inf/NaN
+  operands, results that overflow or go subnormal) are redone with
+  calculate_power_double. Every element therefore gets the same special-case
+  behaviour as the scalar function.
+- Error bounds: f64 results are within 1 ulp, the same as pow_kernel (or the
+  sqrt/cbrt/integer paths for lanes that go scalar). f32 is computed in
+  double and rounded once, so it is within 0.5 ulp plus 2^-28 ulp (double
+  rounding), i.e. effectively correctly rounded.
+- Arrays of BATCH_MIN_CHUNK elements or more are split across threads in
+  cache-line aligned chunks.
+*/
+#define BATCH_MIN_CHUNK (1 << 15)
+#define BATCH_MAX_THREADS 64
+#define BATCH_F32_BLOCK 512
+
+typedef enum {
+    ISA_SCALAR,
+    ISA_AVX2,
+    ISA_AVX512
+} PowerIsa;
+
+typedef void (*BatchKernel)(double *out, const double *x, const double *y, double y_scalar, size_t n);
+
+static void batch_f64_scalar(double *out, const double *x, const double *y, double y_scalar, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = calculate_power_double(x[i], y ? y[i] : y_scalar);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// Exponents calculate_power_double does not send to pow_kernel: integers and the roots
+static int batch_exponent_special(double y) {
+    return y == trunc(y) || y == 0.5 || y == 0.25 || y == 1.0 / 3.0 || y == -0.5;
+}
+
+// Scalar redo of the lanes set in mask, from copies of the inputs so that out may alias x or y
+static void batch_fix_lanes(double *out, const double *xs, const double *ys, unsigned mask) {
+    while (mask) {
+        int lane = __builtin_ctz(mask);
+        out[lane] = calculate_power_double(xs[lane], ys[lane]);
+        mask &= mask - 1;
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void batch_f64_avx2(double *out, const double *x, const double *y, double y_scalar, size_t n) {
+    const __m256i off = _mm256_set1_epi64x((long long)LOG_OFF);
+    const __m256i exp_mask = _mm256_set1_epi64x((long long)(0xfffULL << 52));
+    const __m256i k_bias = _mm256_set1_epi64x(1024LL << 52);
+    const __m256i table_mask = _mm256_set1_epi64x(POW_TABLE_SIZE - 1);
+    const __m256i one_bits = _mm256_set1_epi64x(1023LL << 52);
+    const __m256d shift = _mm256_set1_pd(SHIFT);
+    const __m256i shift_bits = _mm256_castpd_si256(shift);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+
+    if (!y && batch_exponent_special(y_scalar)) {
+        batch_f64_scalar(out, x, NULL, y_scalar, n);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d vx = _mm256_loadu_pd(x + i);
+        __m256d vy = y ? _mm256_loadu_pd(y + i) : _mm256_set1_pd(y_scalar);
+
+        // x = 2^k * z; k + 1024 is read with a logical shift (no 64-bit arithmetic shift in AVX2)
+        __m256i bits = _mm256_castpd_si256(vx);
+        __m256i t = _mm256_sub_epi64(bits, off);
+        __m256i idx = _mm256_and_si256(_mm256_srli_epi64(t, 52 - POW_TABLE_BITS), table_mask);
+        __m256i k = _mm256_srli_epi64(_mm256_add_epi64(t, k_bias), 52);
+        __m256d kd = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(k, shift_bits)),
+                                   _mm256_set1_pd(SHIFT + 1024));
+        __m256d z = _mm256_castsi256_pd(_mm256_sub_epi64(bits, _mm256_and_si256(t, exp_mask)));
+
+        __m256i i3 = _mm256_add_epi64(idx, _mm256_slli_epi64(idx, 1));
+        __m256d invc = _mm256_i64gather_pd(&log_table[0].invc, i3, 8);
+        __m256d logc_hi = _mm256_i64gather_pd(&log_table[0].logc_hi, i3, 8);
+        __m256d logc_lo = _mm256_i64gather_pd(&log_table[0].logc_lo, i3, 8);
+        __m256d r = _mm256_fmsub_pd(z, invc, one);
+
+        // ln(x) = hi + lo
+        __m256d a = _mm256_mul_pd(kd, _mm256_set1_pd(LN2_HI));
+        __m256d t1 = _mm256_add_pd(a, logc_hi);
+        __m256d e1 = _mm256_add_pd(_mm256_sub_pd(a, t1), logc_hi);
+        __m256d hi = _mm256_add_pd(t1, r);
+        __m256d bb = _mm256_sub_pd(hi, t1);
+        __m256d e2 = _mm256_add_pd(_mm256_sub_pd(t1, _mm256_sub_pd(hi, bb)), _mm256_sub_pd(r, bb));
+        __m256d p = _mm256_set1_pd(-1.0/8);
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0/7));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(-1.0/6));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0/5));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(-1.0/4));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0/3));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(-1.0/2));
+        __m256d poly = _mm256_mul_pd(_mm256_mul_pd(r, r), p);
+        __m256d lo = _mm256_add_pd(_mm256_add_pd(e1, e2), _mm256_mul_pd(kd, _mm256_set1_pd(LN2_LO)));
+        lo = _mm256_add_pd(_mm256_add_pd(lo, logc_lo), poly);
+        __m256d sum = _mm256_add_pd(hi, lo);
+        lo = _mm256_sub_pd(lo, _mm256_sub_pd(sum, hi));
+        hi = sum;
+
+        // y * ln(x) = zh + zl
+        __m256d zh = _mm256_mul_pd(vy, hi);
+        __m256d zl = _mm256_fmadd_pd(vy, lo, _mm256_fmsub_pd(vy, hi, zh));
+
+        // exp(zh + zl) = 2^(n/128) * exp(rr)
+        __m256d nd = _mm256_fmadd_pd(zh, _mm256_set1_pd(POW_TABLE_SIZE / 0.69314718055994530942), shift);
+        __m256i nbits = _mm256_sub_epi64(_mm256_castpd_si256(nd), shift_bits);
+        nd = _mm256_sub_pd(nd, shift);
+        __m256d rr = _mm256_fnmadd_pd(nd, _mm256_set1_pd(LN2_HI / POW_TABLE_SIZE), zh);
+        rr = _mm256_add_pd(_mm256_fnmadd_pd(nd, _mm256_set1_pd(LN2_LO / POW_TABLE_SIZE), rr), zl);
+        __m256d q = _mm256_set1_pd(1.0/720);
+        q = _mm256_fmadd_pd(q, rr, _mm256_set1_pd(1.0/120));
+        q = _mm256_fmadd_pd(q, rr, _mm256_set1_pd(1.0/24));
+        q = _mm256_fmadd_pd(q, rr, _mm256_set1_pd(1.0/6));
+        q = _mm256_fmadd_pd(q, rr, _mm256_set1_pd(1.0/2));
+        q = _mm256_fmadd_pd(_mm256_mul_pd(rr, rr), q, rr);
+        __m256i j = _mm256_and_si256(nbits, table_mask);
+        __m256i j2 = _mm256_slli_epi64(j, 1);
+        __m256d t_hi = _mm256_i64gather_pd(&exp2_table[0].hi, j2, 8);
+        __m256d t_lo = _mm256_i64gather_pd(&exp2_table[0].lo, j2, 8);
+        __m256d res = _mm256_add_pd(t_hi, _mm256_fmadd_pd(t_hi, q, t_lo));
+        // 2^floor(n/128): (n - j) << 45 moves n/128 into the exponent field, sign included
+        __m256i scale = _mm256_add_epi64(_mm256_slli_epi64(_mm256_sub_epi64(nbits, j), 52 - POW_TABLE_BITS), one_bits);
+        res = _mm256_mul_pd(res, _mm256_castsi256_pd(scale));
+        __m256d ok = _mm256_and_pd(_mm256_cmp_pd(vx, _mm256_set1_pd(0x1p-1022), _CMP_GE_OQ),
+                                   _mm256_cmp_pd(vx, _mm256_set1_pd(INFINITY), _CMP_LT_OQ));
+        ok = _mm256_and_pd(ok, _mm256_cmp_pd(_mm256_and_pd(vy, abs_mask), _mm256_set1_pd(INFINITY), _CMP_LT_OQ));
+        ok = _mm256_and_pd(ok, _mm256_cmp_pd(_mm256_and_pd(zh, abs_mask), _mm256_set1_pd(708.0), _CMP_LE_OQ));
+        // Integer and root exponents take the scalar paths, as in calculate_power_double
+        __m256d special = _mm256_cmp_pd(_mm256_round_pd(vy, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), vy, _CMP_EQ_OQ);
+        special = _mm256_or_pd(special, _mm256_cmp_pd(vy, _mm256_set1_pd(0.5), _CMP_EQ_OQ));
+        special = _mm256_or_pd(special, _mm256_cmp_pd(vy, _mm256_set1_pd(0.25), _CMP_EQ_OQ));
+        special = _mm256_or_pd(special, _mm256_cmp_pd(vy, _mm256_set1_pd(1.0 / 3.0), _CMP_EQ_OQ));
+        special = _mm256_or_pd(special, _mm256_cmp_pd(vy, _mm256_set1_pd(-0.5), _CMP_EQ_OQ));
+        ok = _mm256_andnot_pd(special, ok);
+        unsigned bad = (unsigned)_mm256_movemask_pd(ok) ^ 0xfu;
+        if (bad) {
+            double xs[4], ys[4];
+            _mm256_storeu_pd(xs, vx);
+            _mm256_storeu_pd(ys, vy);
+            _mm256_storeu_pd(out + i, res);
+            batch_fix_lanes(out + i, xs, ys, bad);
+        } else {
+            _mm256_storeu_pd(out + i, res);
         }
-        else {
-            exponent /= 2; // Divide exponent by 2
+    }
+    batch_f64_scalar(out + i, x + i, y ? y + i : NULL, y_scalar, n - i);
+}
+
+__attribute__((target("avx512f")))
+static void batch_f64_avx512(double *out, const double *x, const double *y, double y_scalar, size_t n) {
+    const __m512i off = _mm512_set1_epi64((long long)LOG_OFF);
+    const __m512i exp_mask = _mm512_set1_epi64((long long)(0xfffULL << 52));
+    const __m512i table_mask = _mm512_set1_epi64(POW_TABLE_SIZE - 1);
+    const __m512i one_bits = _mm512_set1_epi64(1023LL << 52);
+    const __m512d shift = _mm512_set1_pd(SHIFT);
+    const __m512i shift_bits = _mm512_castpd_si512(shift);
+    const __m512d one = _mm512_set1_pd(1.0);
+
+    if (!y && batch_exponent_special(y_scalar)) {
+        batch_f64_scalar(out, x, NULL, y_scalar, n);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d vx = _mm512_loadu_pd(x + i);
+        __m512d vy = y ? _mm512_loadu_pd(y + i) : _mm512_set1_pd(y_scalar);
+
+        // x = 2^k * z
+        __m512i bits = _mm512_castpd_si512(vx);
+        __m512i t = _mm512_sub_epi64(bits, off);
+        __m512i idx = _mm512_and_si512(_mm512_srli_epi64(t, 52 - POW_TABLE_BITS), table_mask);
+        __m512i k = _mm512_srai_epi64(t, 52);
+        __m512d kd = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_add_epi64(k, shift_bits)), shift);
+        __m512d z = _mm512_castsi512_pd(_mm512_sub_epi64(bits, _mm512_and_si512(t, exp_mask)));
+
+        __m512i i3 = _mm512_add_epi64(idx, _mm512_slli_epi64(idx, 1));
+        __m512d invc = _mm512_i64gather_pd(i3, &log_table[0].invc, 8);
+        __m512d logc_hi = _mm512_i64gather_pd(i3, &log_table[0].logc_hi, 8);
+        __m512d logc_lo = _mm512_i64gather_pd(i3, &log_table[0].logc_lo, 8);
+        __m512d r = _mm512_fmsub_pd(z, invc, one);
+
+        // ln(x) = hi + lo
+        __m512d a = _mm512_mul_pd(kd, _mm512_set1_pd(LN2_HI));
+        __m512d t1 = _mm512_add_pd(a, logc_hi);
+        __m512d e1 = _mm512_add_pd(_mm512_sub_pd(a, t1), logc_hi);
+        __m512d hi = _mm512_add_pd(t1, r);
+        __m512d bb = _mm512_sub_pd(hi, t1);
+        __m512d e2 = _mm512_add_pd(_mm512_sub_pd(t1, _mm512_sub_pd(hi, bb)), _mm512_sub_pd(r, bb));
+        __m512d p = _mm512_set1_pd(-1.0/8);
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/7));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(-1.0/6));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/5));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(-1.0/4));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0/3));
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(-1.0/2));
+        __m512d poly = _mm512_mul_pd(_mm512_mul_pd(r, r), p);
+        __m512d lo = _mm512_add_pd(_mm512_add_pd(e1, e2), _mm512_mul_pd(kd, _mm512_set1_pd(LN2_LO)));
+        lo = _mm512_add_pd(_mm512_add_pd(lo, logc_lo), poly);
+        __m512d sum = _mm512_add_pd(hi, lo);
+        lo = _mm512_sub_pd(lo, _mm512_sub_pd(sum, hi));
+        hi = sum;
+
+        // y * ln(x) = zh + zl
+        __m512d zh = _mm512_mul_pd(vy, hi);
+        __m512d zl = _mm512_fmadd_pd(vy, lo, _mm512_fmsub_pd(vy, hi, zh));
+
+        // exp(zh + zl) = 2^(n/128) * exp(rr)
+        __m512d nd = _mm512_fmadd_pd(zh, _mm512_set1_pd(POW_TABLE_SIZE / 0.69314718055994530942), shift);
+        __m512i nbits = _mm512_sub_epi64(_mm512_castpd_si512(nd), shift_bits);
+        nd = _mm512_sub_pd(nd, shift);
+        __m512d rr = _mm512_fnmadd_pd(nd, _mm512_set1_pd(LN2_HI / POW_TABLE_SIZE), zh);
+        rr = _mm512_add_pd(_mm512_fnmadd_pd(nd, _mm512_set1_pd(LN2_LO / POW_TABLE_SIZE), rr), zl);
+        __m512d q = _mm512_set1_pd(1.0/720);
+        q = _mm512_fmadd_pd(q, rr, _mm512_set1_pd(1.0/120));
+        q = _mm512_fmadd_pd(q, rr, _mm512_set1_pd(1.0/24));
+        q = _mm512_fmadd_pd(q, rr, _mm512_set1_pd(1.0/6));
+        q = _mm512_fmadd_pd(q, rr, _mm512_set1_pd(1.0/2));
+        q = _mm512_fmadd_pd(_mm512_mul_pd(rr, rr), q, rr);
+        __m512i j = _mm512_and_si512(nbits, table_mask);
+        __m512i j2 = _mm512_slli_epi64(j, 1);
+        __m512d t_hi = _mm512_i64gather_pd(j2, &exp2_table[0].hi, 8);
+        __m512d t_lo = _mm512_i64gather_pd(j2, &exp2_table[0].lo, 8);
+        __m512d res = _mm512_add_pd(t_hi, _mm512_fmadd_pd(t_hi, q, t_lo));
+        __m512i scale = _mm512_add_epi64(_mm512_slli_epi64(_mm512_sub_epi64(nbits, j), 52 - POW_TABLE_BITS), one_bits);
+        res = _mm512_mul_pd(res, _mm512_castsi512_pd(scale));
+        __mmask8 ok = _mm512_cmp_pd_mask(vx, _mm512_set1_pd(0x1p-1022), _CMP_GE_OQ)
+                    & _mm512_cmp_pd_mask(vx, _mm512_set1_pd(INFINITY), _CMP_LT_OQ)
+                    & _mm512_cmp_pd_mask(_mm512_abs_pd(vy), _mm512_set1_pd(INFINITY), _CMP_LT_OQ)
+                    & _mm512_cmp_pd_mask(_mm512_abs_pd(zh), _mm512_set1_pd(708.0), _CMP_LE_OQ);
+        // Integer and root exponents take the scalar paths, as in calculate_power_double
+        __mmask8 special = _mm512_cmp_pd_mask(_mm512_roundscale_pd(vy, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), vy, _CMP_EQ_OQ)
+                         | _mm512_cmp_pd_mask(vy, _mm512_set1_pd(0.5), _CMP_EQ_OQ)
+                         | _mm512_cmp_pd_mask(vy, _mm512_set1_pd(0.25), _CMP_EQ_OQ)
+                         | _mm512_cmp_pd_mask(vy, _mm512_set1_pd(1.0 / 3.0), _CMP_EQ_OQ)
+                         | _mm512_cmp_pd_mask(vy, _mm512_set1_pd(-0.5), _CMP_EQ_OQ);
+        ok &= (__mmask8)~special;
+        unsigned bad = (unsigned)(uint8_t)~ok;
+        if (bad) {
+            double xs[8], ys[8];
+            _mm512_storeu_pd(xs, vx);
+            _mm512_storeu_pd(ys, vy);
+            _mm512_storeu_pd(out + i, res);
+            batch_fix_lanes(out + i, xs, ys, bad);
+        } else {
+            _mm512_storeu_pd(out + i, res);
         }
-        base *= base; // Square the base
     }
-    return result;
+    batch_f64_avx2(out + i, x + i, y ? y + i : NULL, y_scalar, n - i);
+}
+#endif
+
+static PowerIsa batch_isa = ISA_SCALAR;
+static BatchKernel batch_kernel = batch_f64_scalar;
+
+/*
+- Chooses the kernel used by the batch functions: the requested instruction
+  set, or the best one below it that the CPU supports.
+- Returns the instruction set actually chosen. It is called once at startup
+  with ISA_AVX512; the benchmark calls it again to compare kernels.
+*/
+PowerIsa power_batch_use_isa(PowerIsa wanted) {
+    batch_isa = ISA_SCALAR;
+    batch_kernel = batch_f64_scalar;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (wanted >= ISA_AVX2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        batch_isa = ISA_AVX2;
+        batch_kernel = batch_f64_avx2;
+    }
+    if (wanted >= ISA_AVX512 && batch_isa == ISA_AVX2 && __builtin_cpu_supports("avx512f")) {
+        batch_isa = ISA_AVX512;
+        batch_kernel = batch_f64_avx512;
+    }
+#else
+    (void)wanted;
+#endif
+    return batch_isa;
+}
+
+__attribute__((constructor))
+static void batch_isa_init(void) {
+    power_batch_use_isa(ISA_AVX512);
+}
+
+const char *power_isa_name(PowerIsa isa) {
+    switch (isa) {
+        case ISA_SCALAR: return "scalar";
+        case ISA_AVX2:   return "avx2";
+        case ISA_AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+// f32 goes through the f64 kernel one stack block at a time
+static void batch_f32_range(float *out, const float *x, const float *y, float y_scalar, size_t n) {
+    double xd[BATCH_F32_BLOCK], yd[BATCH_F32_BLOCK], rd[BATCH_F32_BLOCK];
+    for (size_t i = 0; i < n; i += BATCH_F32_BLOCK) {
+        size_t len = n - i < BATCH_F32_BLOCK ? n - i : BATCH_F32_BLOCK;
+        for (size_t j = 0; j < len; j++) xd[j] = x[i + j];
+        if (y) {
+            for (size_t j = 0; j < len; j++) yd[j] = y[i + j];
+        }
+        batch_kernel(rd, xd, y ? yd : NULL, y_scalar, len);
+        for (size_t j = 0; j < len; j++) out[i + j] = (float)rd[j];
+    }
+}
+
+// One thread's share of a batch call
+typedef struct {
+    int is_f32;
+    void *out;
+    const void *x;
+    const void *y;
+    double y_scalar;
+    size_t begin;
+    size_t end;
+} BatchChunk;
+
+static void *batch_worker(void *arg) {
+    BatchChunk *c = arg;
+    size_t n = c->end - c->begin;
+    if (c->is_f32) {
+        const float *y = c->y ? (const float *)c->y + c->begin : NULL;
+        batch_f32_range((float *)c->out + c->begin, (const float *)c->x + c->begin, y, (float)c->y_scalar, n);
+    } else {
+        const double *y = c->y ? (const double *)c->y + c->begin : NULL;
+        batch_kernel((double *)c->out + c->begin, (const double *)c->x + c->begin, y, c->y_scalar, n);
+    }
+    return NULL;
+}
+
+// Splits [0, n) over the threads; chunk 0 runs on the calling thread
+static void batch_run(BatchChunk proto, size_t n, int threads) {
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > BATCH_MAX_THREADS) threads = BATCH_MAX_THREADS;
+    if ((size_t)threads > n / BATCH_MIN_CHUNK) threads = (int)(n / BATCH_MIN_CHUNK);
+    if (threads < 1) threads = 1;
+
+    BatchChunk chunks[BATCH_MAX_THREADS];
+    pthread_t tids[BATCH_MAX_THREADS];
+    int started[BATCH_MAX_THREADS] = {0};
+    size_t per = (n / (size_t)threads + 63) & ~(size_t)63;     // 64 elements: whole cache lines for f32 and f64
+    for (int t = 0; t < threads; t++) {
+        chunks[t] = proto;
+        chunks[t].begin = per * (size_t)t < n ? per * (size_t)t : n;
+        chunks[t].end = per * (size_t)(t + 1) < n && t + 1 < threads ? per * (size_t)(t + 1) : n;
+    }
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&tids[t], NULL, batch_worker, &chunks[t]) == 0;
+        if (!started[t]) batch_worker(&chunks[t]);
+    }
+    batch_worker(&chunks[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(tids[t], NULL);
+    }
+}
+
+/*
+- out[i] = x[i]^y[i], or x[i]^y_scalar when y is NULL.
+- threads <= 0 uses one thread per online CPU; small arrays always stay on
+  the calling thread. out may alias x or y.
+*/
+void power_batch_f64(double *out, const double *x, const double *y, double y_scalar, size_t n, int threads) {
+    BatchChunk proto = {0, out, x, y, y_scalar, 0, 0};
+    batch_run(proto, n, threads);
+}
+
+void power_batch_f32(float *out, const float *x, const float *y, float y_scalar, size_t n, int threads) {
+    BatchChunk proto = {1, out, x, y, y_scalar, 0, 0};
+    batch_run(proto, n, threads);
+}
+
+// Diagnostic text for a PowerStatus
+const char *power_status_text(PowerStatus status) {
+    switch (status) {
+        case POWER_OK:          return "ok";
+        case POWER_OVERFLOW:    return "overflow";
+        case POWER_DIV_BY_ZERO: return "division by zero";
+    }
+    return "unknown";
+}
+
+// Prints a signed 128-bit value
+static void print_i128(i128 v) {
+    char digits[48];
+    int len = 0;
+    u128 mag = v < 0 ? -(u128)v : (u128)v;
+    do {
+        digits[len++] = (char)('0' + (int)(mag % 10));
+        mag /= 10;
+    } while (mag);
+    if (v < 0) putchar('-');
+    while (len > 0) putchar(digits[--len]);
+}
+
+/*
+BENCHMARK
+./main --bench [samples] runs two parts.
+- The accuracy harness. It covers each operand class (int^int, int^float,
+  float^int, float^float) with a grid plus `samples` random cases. Every
+  implementation that can serve the class is run over the cases, and the
+  table shows the max / mean error in ulps against a reference and the time
+  per element. The reference is powl (64-bit mantissa, about 2^-11 double
+  ulp) or, for int^int, the exact __int128 product.
+  A NaN or infinity has to match the reference; any mismatch is counted in
+  the "special" column instead of the ulp figures.
+  Cases whose exact result is beyond the double range are left out.
+- The constant exponent table: calculate_power with constant exponents
+  (expanded by power_chain) against the same exponents passed at run time
+  (the loop in calculate_power_double_int) and against pow().
+Times are the best of BENCH_REPEATS passes, in ns per element.
+*/
+#define BENCH_COUNT (1 << 20)
+#define BENCH_REPEATS 5
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
-int main() {
+// Stores expr(x) for every base and leaves the best time per element in result_ns
+#define BENCH_LOOP(result_ns, expr) do { \
+    double best = INFINITY; \
+    for (int rep = 0; rep < BENCH_REPEATS; rep++) { \
+        double start = now_seconds(); \
+        for (size_t i = 0; i < BENCH_COUNT; i++) { \
+            double x = xs[i]; \
+            out[i] = (expr); \
+        } \
+        double ns = (now_seconds() - start) * 1e9 / BENCH_COUNT; \
+        if (ns < best) best = ns; \
+    } \
+    (result_ns) = best; \
+} while (0)
+
+// One table row; n has to be a literal so that calculate_power sees a constant
+#define BENCH_CHAIN_ROW(n) do { \
+    volatile int hidden = (n); \
+    int runtime_n = hidden; \
+    double t_chain, t_loop, t_pow; \
+    BENCH_LOOP(t_chain, calculate_power(x, n)); \
+    BENCH_LOOP(t_loop, calculate_power(x, runtime_n)); \
+    BENCH_LOOP(t_pow, pow(x, (double)runtime_n)); \
+    printf("%8d %12.2f %12.2f %12.2f\n", (n), t_chain, t_loop, t_pow); \
+} while (0)
+
+static int run_chain_benchmark(void) {
+    double *xs = malloc(BENCH_COUNT * sizeof *xs);
+    double *out = malloc(BENCH_COUNT * sizeof *out);
+    if (!xs || !out) {
+        free(xs);
+        free(out);
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        xs[i] = 0.5 + (double)(state >> 11) * 0x1p-53 * 1.5;     // [0.5, 2): no overflow up to n = 32
+    }
+
+    printf("Constant exponents, ns per element\n");
+    printf("%8s %12s %12s %12s\n", "n", "chain", "runtime n", "pow()");
+    BENCH_CHAIN_ROW(2);
+    BENCH_CHAIN_ROW(3);
+    BENCH_CHAIN_ROW(7);
+    BENCH_CHAIN_ROW(8);
+    BENCH_CHAIN_ROW(15);
+    BENCH_CHAIN_ROW(31);
+    BENCH_CHAIN_ROW(-3);
+
+    free(xs);
+    free(out);
+    return 0;
+}
+
+#define HARNESS_DEFAULT_SAMPLES 100000
+
+typedef long double (*PowerFn)(double x, double y);
+
+// One row of the accuracy table
+typedef struct {
+    const char *name;
+    PowerFn fn;          // called once per element when batch == 0
+    int batch;           // 1: power_batch_f64 on the whole array, 2: power_batch_f32 (error in float ulps)
+} PowerImpl;
+
+// Test cases of one operand class with their reference results
+typedef struct {
+    size_t count;
+    size_t capacity;
+    double *x;
+    double *y;
+    long double *ref;
+} PowerCases;
+
+static long double impl_i64(double x, double y) {
+    int64_t r;
+    return power_i64((int64_t)x, (int64_t)y, POWER_CHECKED, &r) == POWER_OK ? (long double)r : NAN;
+}
+static long double impl_exp_log(double x, double y) { return exp(y * log(x)); }
+static long double impl_pow(double x, double y) { return pow(x, y); }
+static long double impl_double(double x, double y) { return calculate_power_double(x, y); }
+static long double impl_double_int(double x, double y) { return calculate_power_double_int(x, (int64_t)y); }
+static long double impl_chain(double x, double y) { return power_chain(x, (int)y); }
+
+static uint64_t harness_rng = 0x243f6a8885a308d3ULL;
+
+static double harness_uniform(double lo, double hi) {
+    harness_rng = harness_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return lo + (hi - lo) * ((double)(harness_rng >> 11) * 0x1p-53);
+}
+
+// Adds one case unless its reference is outside the double range
+static int cases_add(PowerCases *c, double x, double y, long double ref) {
+    if (!isnan(ref) && (fabsl(ref) > DBL_MAX || (ref != 0 && fabsl(ref) < DBL_TRUE_MIN))) return 1;
+    if (c->count == c->capacity) {
+        size_t cap = c->capacity ? c->capacity * 2 : 4096;
+        double *x2 = realloc(c->x, cap * sizeof *x2);
+        if (x2) c->x = x2;
+        double *y2 = realloc(c->y, cap * sizeof *y2);
+        if (y2) c->y = y2;
+        long double *r2 = realloc(c->ref, cap * sizeof *r2);
+        if (r2) c->ref = r2;
+        if (!x2 || !y2 || !r2) return 0;
+        c->capacity = cap;
+    }
+    c->x[c->count] = x;
+    c->y[c->count] = y;
+    c->ref[c->count] = ref;
+    c->count++;
+    return 1;
+}
+
+static void cases_free(PowerCases *c) {
+    free(c->x);
+    free(c->y);
+    free(c->ref);
+}
+
+// Exact reference for int^int, NAN when it does not fit in int64 (outside power_i64's domain)
+static int add_int_case(PowerCases *c, int64_t b, int64_t e) {
+    i128 r;
+    if (power_i128(b, e, POWER_CHECKED, &r) != POWER_OK || r > INT64_MAX || r < INT64_MIN) return 1;
+    return cases_add(c, (double)b, (double)e, (long double)(int64_t)r);
+}
+
+static int build_cases(int cls, size_t samples, PowerCases *c) {
+    int ok = 1;
+    switch (cls) {
+        case 0:     // int^int
+            for (int b = -12; b <= 12; b++)
+                for (int e = 0; e <= 40; e++) ok &= add_int_case(c, b, e);
+            for (size_t i = 0; i < samples; i++)
+                ok &= add_int_case(c, (int64_t)harness_uniform(-3000, 3000), (int64_t)harness_uniform(0, 64));
+            break;
+        case 1:     // int^float
+            for (int b = 1; b <= 64; b++)
+                for (double e = -10; e <= 10; e += 0.125) ok &= cases_add(c, b, e, powl(b, e));
+            for (size_t i = 0; i < samples; i++) {
+                double b = trunc(harness_uniform(-1000, 1000)), e = harness_uniform(-12, 12);
+                ok &= cases_add(c, b, e, powl(b, e));
+            }
+            break;
+        case 2:     // float^int
+            for (double b = -4; b <= 4; b += 0.0625)
+                for (int e = -40; e <= 40; e++) ok &= cases_add(c, b, e, powl(b, e));
+            for (size_t i = 0; i < samples; i++) {
+                double b = exp2(harness_uniform(-8, 8)) * (i % 2 ? -1 : 1), e = trunc(harness_uniform(-64, 64));
+                ok &= cases_add(c, b, e, powl(b, e));
+            }
+            break;
+        default:    // float^float
+            for (double b = 0.25; b <= 4; b += 0.03125)
+                for (double e = -10; e <= 10; e += 0.0625) ok &= cases_add(c, b, e, powl(b, e));
+            for (size_t i = 0; i < samples; i++) {
+                double b, e;
+                if (i % 4 == 3) {       // near 1 with a large exponent: where exp(y*log(x)) is weakest
+                    b = 1 + harness_uniform(-1e-3, 1e-3);
+                    e = harness_uniform(-2e5, 2e5);
+                } else {
+                    b = exp2(harness_uniform(-40, 40));
+                    e = harness_uniform(-25, 25);
+                }
+                ok &= cases_add(c, b, e, powl(b, e));
+            }
+            break;
+    }
+    return ok;
+}
+
+// Error of got in ulps of the reference rounded to the output type (53 or 24 bits)
+static double ulp_error(long double got, long double ref, int bits, int min_exp, size_t *special) {
+    if (got == ref) return 0;
+    if (isnan(ref) || isnan(got) || isinf(got) || isinf(ref)) {
+        if (!(isnan(ref) && isnan(got))) (*special)++;
+        return 0;
+    }
+    if (ref == 0) {
+        (*special)++;
+        return 0;
+    }
+    int e;
+    frexpl(ref, &e);
+    int ulp_exp = e - bits > min_exp ? e - bits : min_exp;
+    return (double)(fabsl(got - ref) / ldexpl(1.0L, ulp_exp));
+}
+
+static void run_impl(const PowerImpl *impl, const PowerCases *c, long double *out, double *tmp) {
+    size_t n = c->count;
+    double best = INFINITY;
+    float *xf = NULL, *yf = NULL, *of = NULL;
+    if (impl->batch == 2) {
+        xf = malloc(n * sizeof *xf);
+        yf = malloc(n * sizeof *yf);
+        of = malloc(n * sizeof *of);
+        if (!xf || !yf || !of) {
+            printf("  %-26s out of memory\n", impl->name);
+            free(xf);
+            free(yf);
+            free(of);
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            xf[i] = (float)c->x[i];
+            yf[i] = (float)c->y[i];
+        }
+    }
+
+    for (int rep = 0; rep < BENCH_REPEATS; rep++) {
+        double start = now_seconds();
+        if (impl->batch == 1) {
+            power_batch_f64(tmp, c->x, c->y, 0, n, 1);
+        } else if (impl->batch == 2) {
+            power_batch_f32(of, xf, yf, 0, n, 1);
+        } else {
+            for (size_t i = 0; i < n; i++) out[i] = impl->fn(c->x[i], c->y[i]);
+        }
+        double ns = (now_seconds() - start) * 1e9 / n;
+        if (ns < best) best = ns;
+    }
+
+    double max_err = 0, sum_err = 0;
+    size_t special = 0;
+    for (size_t i = 0; i < n; i++) {
+        double err;
+        if (impl->batch == 2) {
+            long double ref = powl(xf[i], yf[i]);
+            if (!isnan(ref) && fabsl(ref) > FLT_MAX) ref = INFINITY;
+            if (fabsl(ref) < FLT_MIN) ref = (float)ref;     // subnormal range: compare with the rounded value
+            err = ulp_error(of[i], ref, 24, -149, &special);
+        } else {
+            long double got = impl->batch == 1 ? (long double)tmp[i] : out[i];
+            err = ulp_error(got, c->ref[i], 53, -1074, &special);
+        }
+        if (err > max_err) max_err = err;
+        sum_err += err;
+    }
+    printf("  %-26s %12.3f %10.4f %9zu %9.2f\n", impl->name, max_err, sum_err / n, special, best);
+    free(xf);
+    free(yf);
+    free(of);
+}
+
+static int run_accuracy_harness(size_t samples) {
+    static const char *class_names[4] = {"int^int", "int^float", "float^int", "float^float"};
+    static const PowerImpl impls[4][6] = {
+        {
+            {"calculate_power (power_i64)", impl_i64, 0},
+            {"exp(y*log(x))", impl_exp_log, 0},
+            {"pow()", impl_pow, 0},
+        },
+        {
+            {"calculate_power_double", impl_double, 0},
+            {"exp(y*log(x))", impl_exp_log, 0},
+            {"pow()", impl_pow, 0},
+            {"power_batch_f64", NULL, 1},
+        },
+        {
+            {"calculate_power_double_int", impl_double_int, 0},
+            {"power_chain (runtime n)", impl_chain, 0},
+            {"calculate_power_double", impl_double, 0},
+            {"exp(y*log(x))", impl_exp_log, 0},
+            {"pow()", impl_pow, 0},
+        },
+        {
+            {"calculate_power_double", impl_double, 0},
+            {"exp(y*log(x))", impl_exp_log, 0},
+            {"pow()", impl_pow, 0},
+            {"power_batch_f64", NULL, 1},
+            {"power_batch_f32 (f32 ulp)", NULL, 2},
+        },
+    };
+
+    printf("Accuracy against powl / exact integers (batch kernels: %s)\n", power_isa_name(batch_isa));
+    for (int cls = 0; cls < 4; cls++) {
+        PowerCases cases = {0};
+        long double *out = NULL;
+        double *tmp = NULL;
+        if (!build_cases(cls, samples, &cases) ||
+            !(out = malloc(cases.count * sizeof *out)) || !(tmp = malloc(cases.count * sizeof *tmp))) {
+            fprintf(stderr, "out of memory\n");
+            free(out);
+            cases_free(&cases);
+            return 1;
+        }
+        printf("\n%s (%zu cases)\n", class_names[cls], cases.count);
+        printf("  %-26s %12s %10s %9s %9s\n", "implementation", "max ulp", "mean ulp", "special", "ns/op");
+        for (int i = 0; i < 6 && impls[cls][i].name; i++) run_impl(&impls[cls][i], &cases, out, tmp);
+        free(out);
+        free(tmp);
+        cases_free(&cases);
+    }
+    printf("\n");
+    return 0;
+}
+
+static int run_benchmark(size_t samples) {
+    if (run_accuracy_harness(samples)) return 1;
+    return run_chain_benchmark();
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        size_t samples = argc > 2 ? strtoull(argv[2], NULL, 10) : HARNESS_DEFAULT_SAMPLES;
+        return run_benchmark(samples);
+    }
+
     double base = 3.141;
     double exponent = 2.78;
+    printf("Calculating power for doubles: %.2f^%.2f\n", base, exponent);
     double result = calculate_power(base, exponent);
     printf("The result of %.2f raised to the power of %.2f is %.2f\n", base, exponent, result);
     printf("The result of %.2f raised to the power of %.2f using pow() is %.2f\n", base, exponent, pow(base, exponent));
 
+    // Exponent classes: integer valued, roots and the floating base with an int exponent
+    printf("(-2.0)^3.0 = %g, exp/log gives %g\n", calculate_power(-2.0, 3.0), exp(3.0 * log(-2.0)));
+    printf("1.5^-40 = %.17g, pow() gives %.17g\n", calculate_power(1.5, -40), pow(1.5, -40));
+    printf("2.0^0.5 = %.17g, 27.0^(1/3) = %.17g\n", calculate_power(2.0, 0.5), calculate_power(27.0, 1.0 / 3.0));
+    printf("1.0001^1e6 = %.17g, pow() gives %.17g, exp/log gives %.17g\n",
+           calculate_power(1.0001, 1e6), pow(1.0001, 1e6), exp(1e6 * log(1.0001)));
+
 
     int int_base = -4;
     int int_exponent = 9;
     // 4^10 works well with the integer power function
-    // but 4^16 will overflow for int, so we should use the double version for larger powers
-    // This is a good test case for the integer power function.
+    // but 4^16 will overflow for int; power_i64 reports it instead of wrapping.
 
+    printf("Calculating power for integers: %d^%d\n", int_base, int_exponent);
     int int_result = calculate_power(int_base, int_exponent);
     printf("The result of %d raised to the power of %d is %d\n", int_base, int_exponent, int_result);
     printf("The result of %d raised to the power of %d using pow() is %.2f\n", int_base, int_exponent, pow(int_base, int_exponent));
+
+    // Overflow reporting
+    int64_t r64;
+    PowerStatus status = power_i64(4, 16, POWER_CHECKED, &r64);
+    printf("\n4^16 in 64 bits: %lld (%s), as int: %d (saturated)\n", (long long)r64, power_status_text(status),
+           calculate_power_int(4, 16));
+    status = power_i64(3, 40, POWER_CHECKED, &r64);
+    printf("3^40 in 64 bits, checked: %s\n", power_status_text(status));
+    status = power_i64(-3, 41, POWER_SATURATING, &r64);
+    printf("(-3)^41 in 64 bits, saturating: %lld (%s)\n", (long long)r64, power_status_text(status));
+    uint64_t ru64;
+    status = power_u64(2, 64, POWER_SATURATING, &ru64);
+    printf("2^64 unsigned, saturating: %llu (%s)\n", (unsigned long long)ru64, power_status_text(status));
+    i128 r128;
+    status = power_i128(3, 40, POWER_CHECKED, &r128);
+    printf("3^40 in 128 bits: ");
+    print_i128(r128);
+    printf(" (%s)\n", power_status_text(status));
+    status = power_i64(0, -1, POWER_CHECKED, &r64);
+    printf("0^-1: %s\n", power_status_text(status));
+
+    // Batch power over arrays
+    double xs[8] = {1, 2, 3, 4, 5, -2, 0, 1e300};
+    double ys[8] = {0.5, 10, -1.5, 0.25, 3.3, 3, -1, 2};
+    double out[8];
+    power_batch_f64(out, xs, ys, 0, 8, 1);
+    printf("\nBatch power (%s kernel):", power_isa_name(batch_isa));
+    for (int i = 0; i < 8; i++) printf(" %g^%g=%g", xs[i], ys[i], out[i]);
+    printf("\n");
+
+    // Modular power
+    printf("\n3^(10^18) mod (10^9+7) = %llu\n", (unsigned long long)powmod(3, 1000000000000000000ULL, 1000000007ULL));
+    printf("2^(2^64-1) mod (2^64-59) = %llu\n", (unsigned long long)powmod(2, UINT64_MAX, 18446744073709551557ULL));
     return 0;
-}
\ No newline at end of file
+}
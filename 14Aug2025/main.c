@@ -46,8 +46,154 @@ Space Complexity:
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <pthread.h>
 
 #define MAX_DIGITS 10   // We are dealing with digits 0–9 (total 10)
+#define WRITER_BUFFER_SIZE (4 << 20)    // 4 MB per write() call
+#define WRITER_ALIGN 4096               // page aligned buffer
+
+// ----------------------------------------------------
+// Output backend: PermWriter
+// Every permutation line has the same width (n digits + '\n'), so the
+// text is produced as raw bytes instead of one fprintf per digit.
+//
+// Two modes:
+//   WRITER_BUFFERED -> fill a page aligned 4 MB buffer, flush it with write()
+//   WRITER_MMAP     -> size the file up front (ftruncate) and store the
+//                      bytes straight into a shared mapping of it
+//
+// writerOpen returns 0 on success, -1 on failure (errno is set).
+// Write errors are remembered and reported by writerClose.
+// ----------------------------------------------------
+typedef enum {
+    WRITER_BUFFERED,
+    WRITER_MMAP
+} WriterMode;
+
+// Record layout, see Part 5. Plain text unless writerOpenFormat says otherwise.
+typedef enum {
+    PERM_FORMAT_TEXT,
+    PERM_FORMAT_NIBBLE,
+    PERM_FORMAT_LEHMER,
+    PERM_FORMAT_RANK_DELTA
+} PermFormat;
+
+typedef struct {
+    WriterMode mode;
+    int fd;
+    char *buf;      // aligned buffer, or the mapped file
+    size_t pos;     // bytes used in buf
+    size_t cap;     // size of buf
+    int failed;     // a write() or the mapping failed
+    PermFormat format;
+    int n;                          // symbols per binary record
+    int width;                      // bytes per PERM_FORMAT_LEHMER record
+    unsigned long long prevRank;    // PERM_FORMAT_RANK_DELTA state
+} PermWriter;
+
+// Writes all len bytes, retrying short writes and EINTR
+static int writeAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t done = write(fd, data, len);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += done;
+        len -= (size_t)done;
+    }
+    return 0;
+}
+
+// totalBytes is required for WRITER_MMAP (the exact output size) and ignored otherwise
+int writerOpen(PermWriter *w, const char *path, WriterMode mode, size_t totalBytes) {
+    memset(w, 0, sizeof *w);
+    w->mode = mode;
+    w->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (w->fd < 0) return -1;
+
+    if (mode == WRITER_MMAP) {
+        w->cap = totalBytes;
+        if (totalBytes == 0) return 0;
+        if (ftruncate(w->fd, (off_t)totalBytes) != 0) goto fail;
+        w->buf = mmap(NULL, totalBytes, PROT_READ | PROT_WRITE, MAP_SHARED, w->fd, 0);
+        if (w->buf == MAP_FAILED) {
+            w->buf = NULL;
+            goto fail;
+        }
+        madvise(w->buf, totalBytes, MADV_SEQUENTIAL);
+        return 0;
+    }
+
+    w->cap = WRITER_BUFFER_SIZE;
+    if (posix_memalign((void **)&w->buf, WRITER_ALIGN, w->cap) != 0) {
+        w->buf = NULL;
+        errno = ENOMEM;
+        goto fail;
+    }
+    return 0;
+
+fail:
+    {
+        int saved = errno;
+        close(w->fd);
+        w->fd = -1;
+        errno = saved;
+    }
+    return -1;
+}
+
+// Hands the buffered bytes to the kernel (buffered mode only)
+static void writerFlush(PermWriter *w) {
+    if (w->mode == WRITER_BUFFERED && w->pos > 0) {
+        if (!w->failed && writeAll(w->fd, w->buf, w->pos) != 0) w->failed = 1;
+        w->pos = 0;
+    }
+}
+
+static void writerPutBinary(PermWriter *w, const int *perm, int n);
+
+// Appends one permutation line: n digits and a newline (or one binary record)
+static inline void writerPut(PermWriter *w, const int *perm, int n) {
+    if (w->format != PERM_FORMAT_TEXT) {
+        writerPutBinary(w, perm, n);
+        return;
+    }
+    size_t len = (size_t)n + 1;
+    if (w->pos + len > w->cap) {
+        if (w->mode == WRITER_MMAP) {     // more lines than the size given to writerOpen
+            w->failed = 1;
+            return;
+        }
+        writerFlush(w);
+    }
+    char *p = w->buf + w->pos;
+    for (int i = 0; i < n; i++) p[i] = (char)('0' + perm[i]);
+    p[n] = '\n';
+    w->pos += len;
+}
+
+// Flushes or unmaps, closes the file; returns 0 if every byte made it out
+int writerClose(PermWriter *w) {
+    if (w->mode == WRITER_MMAP) {
+        if (w->buf) munmap(w->buf, w->cap);
+        if (w->pos != w->cap && ftruncate(w->fd, (off_t)w->pos) != 0) w->failed = 1;
+    } else {
+        writerFlush(w);
+        free(w->buf);
+    }
+    if (close(w->fd) != 0) w->failed = 1;
+    w->buf = NULL;
+    w->fd = -1;
+    return w->failed ? -1 : 0;
+}
 
 // ----------------------------------------------------
 // Utility function: Swap two integers
@@ -59,6 +205,44 @@ void swap(int *a, int *b) {
     *b = temp;
 }
 
+// ----------------------------------------------------
+// Visitors
+// The generators below do not write anything themselves. They hand each
+// finished permutation to a PermVisitor, and, if one is given, ask a
+// PermPrune about every prefix before extending it:
+//
+//   visit(perm, n, ctx)      -> 0 to continue; any other value stops the
+//                               generation and is returned by the generator
+//   prune(prefix, len, ctx)  -> non-zero skips every permutation that starts
+//                               with prefix[0..len)
+//
+// perm and prefix point into the generator's working array, so they are
+// only valid during the call. writerVisitor turns a PermWriter into a
+// visitor; it stops the generation on the first write error. countVisitor
+// counts into an unsigned long long, and noLeadingZero prunes every
+// prefix that starts with the digit 0.
+// ----------------------------------------------------
+typedef int (*PermVisitor)(const int *perm, int n, void *ctx);
+typedef int (*PermPrune)(const int *prefix, int len, void *ctx);
+
+int writerVisitor(const int *perm, int n, void *ctx) {
+    PermWriter *w = ctx;
+    writerPut(w, perm, n);
+    return w->failed;
+}
+
+int countVisitor(const int *perm, int n, void *ctx) {
+    (void)perm;
+    (void)n;
+    ++*(unsigned long long *)ctx;
+    return 0;
+}
+
+int noLeadingZero(const int *prefix, int len, void *ctx) {
+    (void)ctx;
+    return len == 1 && prefix[0] == 0;
+}
+
 // ----------------------------------------------------
 // Part 1: Generate all permutations (assuming NO duplicates)
 // Method: Backtracking with recursive swapping
@@ -67,28 +251,34 @@ void swap(int *a, int *b) {
 //   arr   -> array of digits
 //   start -> current position to fix a digit
 //   end   -> last index in the array
-//   fptr  -> file pointer to write permutations
+//   visit -> called with each permutation
+//   prune -> called with each prefix arr[0..start], may be NULL
+//   ctx   -> passed to visit and prune
 //
 // Logic:
 //   - Fix one digit at 'start'
 //   - Recursively permute remaining elements
 //   - Swap back (backtrack) to restore original order
+//
+// Returns 0, or the non-zero value that made visit stop early.
+// arr is back in its original order either way.
 // ----------------------------------------------------
-void generatePermutations(int *arr, int start, int end, FILE *fptr) {
+int generatePermutations(int *arr, int start, int end, PermVisitor visit, PermPrune prune, void *ctx) {
     if (start == end) {
         // Base case: one valid permutation is formed
-        for (int i = 0; i <= end; i++)
-            fprintf(fptr, "%d", arr[i]);  // Write permutation to file
-        fprintf(fptr, "\n");
-        return;
+        return visit(arr, end + 1, ctx);
     }
 
     // Try placing each possible digit at index 'start'
     for (int i = start; i <= end; i++) {
         swap(&arr[start], &arr[i]);                   // Fix digit at 'start'
-        generatePermutations(arr, start + 1, end, fptr); // Recurse on remaining
+        int stop = 0;
+        if (!prune || !prune(arr, start + 1, ctx))
+            stop = generatePermutations(arr, start + 1, end, visit, prune, ctx);  // Recurse on remaining
         swap(&arr[start], &arr[i]);                   // Backtrack
+        if (stop) return stop;
     }
+    return 0;
 }
 
 // ----------------------------------------------------
@@ -104,15 +294,15 @@ void generatePermutations(int *arr, int start, int end, FILE *fptr) {
 //   n       -> total number of elements in input
 //   level   -> current recursion depth
 //   result[]-> stores one candidate permutation
-//   fptr    -> file pointer to write permutations
+//   visit, prune, ctx -> as for generatePermutations
+//
+// Returns 0, or the non-zero value that made visit stop early.
+// freq is restored either way.
 // ----------------------------------------------------
-void generateUniquePermutations(int *freq, int n, int level, int *result, FILE *fptr) {
+int generateUniquePermutations(int *freq, int n, int level, int *result, PermVisitor visit, PermPrune prune, void *ctx) {
     if (level == n) {
-        // Base case: all positions filled, write to file
-        for (int i = 0; i < n; i++)
-            fprintf(fptr, "%d", result[i]);
-        fprintf(fptr, "\n");
-        return;
+        // Base case: all positions filled
+        return visit(result, n, ctx);
     }
 
     // Try all possible digits 0–9
@@ -120,10 +310,925 @@ void generateUniquePermutations(int *freq, int n, int level, int *result, FILE *
         if (freq[d] > 0) {              // Use digit only if available
             freq[d]--;                  // Use it
             result[level] = d;          // Place it in current position
-            generateUniquePermutations(freq, n, level + 1, result, fptr); // Recurse
+            int stop = 0;
+            if (!prune || !prune(result, level + 1, ctx))
+                stop = generateUniquePermutations(freq, n, level + 1, result, visit, prune, ctx); // Recurse
             freq[d]++;                  // Backtrack (restore)
+            if (stop) return stop;
         }
     }
+    return 0;
+}
+
+// ----------------------------------------------------
+// Part 3: Iterative generators behind one iterator interface
+//
+//   PermIterator it;
+//   permIterInit(&it, PERM_HEAP, items, n);
+//   while (permIterNext(&it)) use(it.perm);
+//
+// The first call returns the starting arrangement; every later call
+// changes it into the next permutation in place. None of them recurse,
+// and each does O(1) amortized work per permutation:
+//
+//   PERM_HEAP          -> Heap's algorithm, one swap per step
+//   PERM_LEXICOGRAPHIC -> next-permutation in sorted order; duplicates in
+//                         items give each distinct permutation once
+//   PERM_PLAIN_CHANGES -> Steinhaus–Johnson–Trotter (Knuth 7.2.1.2 P),
+//                         neighbours swap, a Gray code on arrangements
+//   PERM_EHRLICH       -> Ehrlich swaps (Knuth 7.2.1.2 E), always swaps
+//                         position 0 with another position
+//
+// All but PERM_LEXICOGRAPHIC treat the items as distinct and produce n!
+// arrangements even when values repeat.
+// ----------------------------------------------------
+#define MAX_PERM_N 20    // 20! still fits in 64 bits
+#define PARALLEL_MAX_THREADS 64
+
+typedef enum {
+    PERM_HEAP,
+    PERM_LEXICOGRAPHIC,
+    PERM_PLAIN_CHANGES,
+    PERM_EHRLICH
+} PermAlgorithm;
+
+typedef struct {
+    PermAlgorithm algorithm;
+    int n;
+    int perm[MAX_PERM_N];       // current permutation
+    int c[MAX_PERM_N + 1];      // Heap: loop counters; plain changes / Ehrlich: mixed radix digits
+    int o[MAX_PERM_N + 1];      // plain changes: direction of each element
+    int b[MAX_PERM_N];          // Ehrlich: which position swaps with 0
+    int i;                      // Heap: current level
+    int started;
+    int done;
+} PermIterator;
+
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// items is copied; n must be in 0..MAX_PERM_N
+void permIterInit(PermIterator *it, PermAlgorithm algorithm, const int *items, int n) {
+    memset(it, 0, sizeof *it);
+    it->algorithm = algorithm;
+    it->n = n;
+    memcpy(it->perm, items, (size_t)n * sizeof(int));
+    if (algorithm == PERM_LEXICOGRAPHIC) qsort(it->perm, (size_t)n, sizeof(int), compareInts);
+    for (int j = 0; j <= n; j++) it->o[j] = 1;
+    for (int j = 0; j < n; j++) it->b[j] = j;
+}
+
+// Heap's algorithm, iterative form: c[i] counts the swaps done at level i
+static int heapNext(PermIterator *it) {
+    int *a = it->perm;
+    while (it->i < it->n) {
+        int i = it->i;
+        if (it->c[i] < i) {
+            int j = (i % 2 == 0) ? 0 : it->c[i];
+            swap(&a[j], &a[i]);
+            it->c[i]++;
+            it->i = 1;
+            return 1;
+        }
+        it->c[i] = 0;
+        it->i++;
+    }
+    return 0;
+}
+
+// Next permutation in lexicographic order: find the rightmost ascent,
+// swap in the next larger element, reverse the suffix.
+// Returns 0 (and leaves a unchanged) when a is already the last one.
+static int nextPermutation(int *a, int n) {
+    int k = n - 2;
+    while (k >= 0 && a[k] >= a[k + 1]) k--;
+    if (k < 0) return 0;
+    int l = n - 1;
+    while (a[l] <= a[k]) l--;
+    swap(&a[k], &a[l]);
+    for (int x = k + 1, y = n - 1; x < y; x++, y--) swap(&a[x], &a[y]);
+    return 1;
+}
+
+static int lexicographicNext(PermIterator *it) {
+    return nextPermutation(it->perm, it->n);
+}
+
+// Knuth's Algorithm P (plain changes), 1-based j as in the book
+static int plainChangesNext(PermIterator *it) {
+    int *a = it->perm - 1;      // a[1..n]
+    int j = it->n, s = 0;
+    while (j > 1) {
+        int q = it->c[j] + it->o[j];
+        if (q >= 0 && q != j) {
+            swap(&a[j - it->c[j] + s], &a[j - q + s]);
+            it->c[j] = q;
+            return 1;
+        }
+        if (q == j) s++;        // element n-j+1 is at its far end: shift the window
+        it->o[j] = -it->o[j];
+        j--;
+    }
+    return 0;
+}
+
+// Knuth's Algorithm E (Ehrlich swaps): a[0] swaps with a[b[k]]
+static int ehrlichNext(PermIterator *it) {
+    int k = 1;
+    while (k < it->n && it->c[k] == k) {
+        it->c[k] = 0;
+        k++;
+    }
+    if (k >= it->n) return 0;
+    it->c[k]++;
+    swap(&it->perm[0], &it->perm[it->b[k]]);
+    for (int j = 1, m = k - 1; j < m; j++, m--) swap(&it->b[j], &it->b[m]);
+    return 1;
+}
+
+// Returns 1 when it->perm holds the next permutation, 0 once all have been produced
+int permIterNext(PermIterator *it) {
+    if (it->done) return 0;
+    if (!it->started) {
+        it->started = 1;
+        it->i = 1;
+        return 1;
+    }
+    int more = 0;
+    switch (it->algorithm) {
+        case PERM_HEAP:          more = heapNext(it); break;
+        case PERM_LEXICOGRAPHIC: more = lexicographicNext(it); break;
+        case PERM_PLAIN_CHANGES: more = plainChangesNext(it); break;
+        case PERM_EHRLICH:       more = ehrlichNext(it); break;
+    }
+    if (!more) it->done = 1;
+    return more;
+}
+
+// ----------------------------------------------------
+// Part 4: Ranks and parallel output
+//
+// Permutations in lexicographic order are numbered 0, 1, 2, ...
+// The factorial number system turns a rank of a permutation of 0..n-1
+// into its Lehmer code and back: digit i (radix n-i) counts the unused
+// values smaller than perm[i]. Multisets are ranked the same way by
+// kthUniquePermutation / rankUniquePermutation below.
+//
+// Every output line is n + 1 bytes, so the line of rank r starts at byte
+// r * (n + 1). writePermutationsParallel sizes the file, gives each thread
+// a contiguous range of ranks, and each thread unranks its first
+// permutation, steps with nextPermutation and pwrite()s its own region.
+// All values here fit in 64 bits because n <= MAX_PERM_N.
+// ----------------------------------------------------
+typedef unsigned __int128 u128;
+
+unsigned long long factorial(int n) {
+    unsigned long long f = 1;
+    for (int i = 2; i <= n; i++) f *= (unsigned long long)i;
+    return f;
+}
+
+// Rank of a permutation of 0..n-1, O(n) with a bitmask of used values
+unsigned long long rankPermutation(const int *perm, int n) {
+    unsigned long long rank = 0;
+    unsigned used = 0;
+    for (int i = 0; i < n; i++) {
+        int v = perm[i];
+        int smaller = v - __builtin_popcount(used & ((1u << v) - 1));
+        rank = rank * (unsigned long long)(n - i) + (unsigned long long)smaller;
+        used |= 1u << v;
+    }
+    return rank;
+}
+
+// Inverse of rankPermutation; rank must be below n!
+void unrankPermutation(unsigned long long rank, int n, int *perm) {
+    int digit[MAX_PERM_N];
+    for (int i = n - 1; i >= 0; i--) {
+        digit[i] = (int)(rank % (unsigned long long)(n - i));
+        rank /= (unsigned long long)(n - i);
+    }
+    unsigned unused = (n < 32) ? (1u << n) - 1 : ~0u;
+    for (int i = 0; i < n; i++) {
+        unsigned bits = unused;
+        for (int k = 0; k < digit[i]; k++) bits &= bits - 1;    // drop the digit[i] smallest
+        int v = __builtin_ctz(bits);
+        perm[i] = v;
+        unused &= ~(1u << v);
+    }
+}
+
+// ----------------------------------------------------
+// Multiset counts and random access
+//
+// A multiset over symbols 0..sigma-1 is given by freq[0..sigma). Its number
+// of distinct arrangements is the multinomial n! / (freq[0]! ... freq[sigma-1]!).
+// It is built one item at a time as count = count * placed / j, and every
+// partial value is itself the multinomial of the items placed so far, so the
+// division is exact and the partial values never exceed the final count.
+//
+// kthUniquePermutation and rankUniquePermutation walk the positions left to
+// right. With M arrangements of the remaining items, putting symbol d next
+// leaves M * freq[d] / remaining of them, so the k-th permutation is found by
+// skipping whole blocks: O(n * sigma) multiplications in total.
+//
+// The 64-bit functions return -1 when a count or rank does not fit. The *Big
+// versions are exact for any size and use BigInt (base 2^32 limbs, least
+// significant first). All their values are below (n + 1)!, which fixes the
+// number of limbs up front.
+// ----------------------------------------------------
+
+// Returns 0 and stores the multinomial in *count, or -1 if it needs more than 64 bits
+int multinomialCount(const int *freq, int sigma, unsigned long long *count) {
+    unsigned long long c = 1;
+    unsigned long long placed = 0;
+    for (int s = 0; s < sigma; s++) {
+        for (int j = 1; j <= freq[s]; j++) {
+            placed++;
+            u128 next = (u128)c * placed / (unsigned)j;
+            if (next > ~0ULL) return -1;
+            c = (unsigned long long)next;
+        }
+    }
+    *count = c;
+    return 0;
+}
+
+typedef struct {
+    uint32_t *limb;
+    size_t len;     // used limbs (no leading zero limbs)
+    size_t cap;
+} BigInt;
+
+// Room for any value below (n + 1)!; returns -1 (x->limb == NULL) if out of memory
+static int bigInit(BigInt *x, unsigned long long n, unsigned long long value) {
+    int bits = 0;
+    for (unsigned long long v = n + 1; v; v >>= 1) bits++;
+    x->cap = (size_t)((n + 1) * (unsigned long long)bits / 32 + 3);
+    x->len = 0;
+    x->limb = calloc(x->cap, sizeof(uint32_t));
+    if (!x->limb) return -1;
+    x->limb[0] = (uint32_t)value;
+    x->limb[1] = (uint32_t)(value >> 32);
+    x->len = value == 0 ? 0 : (value >> 32) ? 2 : 1;
+    return 0;
+}
+
+void bigFree(BigInt *x) {
+    free(x->limb);
+    x->limb = NULL;
+    x->len = x->cap = 0;
+}
+
+static void bigCopy(BigInt *dst, const BigInt *src) {
+    memcpy(dst->limb, src->limb, src->len * sizeof(uint32_t));
+    memset(dst->limb + src->len, 0, (dst->cap - src->len) * sizeof(uint32_t));
+    dst->len = src->len;
+}
+
+static void bigMulSmall(BigInt *x, uint32_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < x->len; i++) {
+        carry += (uint64_t)x->limb[i] * m;
+        x->limb[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry) x->limb[x->len++] = (uint32_t)carry;
+    while (x->len > 0 && x->limb[x->len - 1] == 0) x->len--;
+}
+
+// x /= d, returns the remainder
+static uint32_t bigDivSmall(BigInt *x, uint32_t d) {
+    uint64_t rem = 0;
+    for (size_t i = x->len; i-- > 0;) {
+        uint64_t cur = (rem << 32) | x->limb[i];
+        x->limb[i] = (uint32_t)(cur / d);
+        rem = cur % d;
+    }
+    while (x->len > 0 && x->limb[x->len - 1] == 0) x->len--;
+    return (uint32_t)rem;
+}
+
+static int bigCompare(const BigInt *a, const BigInt *b) {
+    if (a->len != b->len) return a->len < b->len ? -1 : 1;
+    for (size_t i = a->len; i-- > 0;) {
+        if (a->limb[i] != b->limb[i]) return a->limb[i] < b->limb[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// a += b
+static void bigAdd(BigInt *a, const BigInt *b) {
+    uint64_t carry = 0;
+    size_t n = a->len > b->len ? a->len : b->len;
+    for (size_t i = 0; i < n; i++) {
+        carry += (uint64_t)a->limb[i] + (i < b->len ? b->limb[i] : 0);
+        a->limb[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    a->len = n;
+    if (carry) a->limb[a->len++] = (uint32_t)carry;
+}
+
+// a -= b, requires a >= b
+static void bigSub(BigInt *a, const BigInt *b) {
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a->len; i++) {
+        int64_t d = (int64_t)a->limb[i] - (i < b->len ? b->limb[i] : 0) - borrow;
+        borrow = d < 0;
+        a->limb[i] = (uint32_t)d;
+    }
+    while (a->len > 0 && a->limb[a->len - 1] == 0) a->len--;
+}
+
+// Converts a BigInt to a decimal string (caller frees), NULL if out of memory
+char *bigToDecimal(const BigInt *x) {
+    BigInt work;
+    work.cap = x->len + 1;
+    work.limb = calloc(work.cap, sizeof(uint32_t));
+    uint32_t *chunks = malloc((x->len * 10 / 9 + 2) * sizeof(uint32_t));   // base 10^9 digits
+    char *s = NULL;
+    if (!work.limb || !chunks) goto done;
+    bigCopy(&work, x);
+    size_t nchunks = 0;
+    while (work.len > 0) chunks[nchunks++] = bigDivSmall(&work, 1000000000u);
+
+    s = malloc(nchunks * 9 + 2);
+    if (!s) goto done;
+    if (nchunks == 0) {
+        strcpy(s, "0");
+    } else {
+        int len = sprintf(s, "%u", chunks[nchunks - 1]);
+        for (size_t i = nchunks - 1; i-- > 0;) len += sprintf(s + len, "%09u", chunks[i]);
+    }
+done:
+    bigFree(&work);
+    free(chunks);
+    return s;
+}
+
+static unsigned long long totalItems(const int *freq, int sigma) {
+    unsigned long long n = 0;
+    for (int s = 0; s < sigma; s++) n += (unsigned long long)freq[s];
+    return n;
+}
+
+// Exact multinomial into *count (free it with bigFree); -1 if out of memory
+int multinomialBig(const int *freq, int sigma, BigInt *count) {
+    if (bigInit(count, totalItems(freq, sigma), 1) != 0) return -1;
+    uint32_t placed = 0;
+    for (int s = 0; s < sigma; s++) {
+        for (int j = 1; j <= freq[s]; j++) {
+            bigMulSmall(count, ++placed);
+            bigDivSmall(count, (uint32_t)j);
+        }
+    }
+    return 0;
+}
+
+// Writes the k-th (0-based, lexicographic) distinct permutation of freq into perm.
+// Returns 0, or -1 if k is not below the number of permutations or memory runs out.
+int kthUniquePermutationBig(const int *freq, int sigma, const BigInt *k, int *perm) {
+    BigInt arrangements;
+    if (multinomialBig(freq, sigma, &arrangements) != 0) return -1;
+    if (bigCompare(k, &arrangements) >= 0) {
+        bigFree(&arrangements);
+        return -1;
+    }
+
+    int *f = malloc((size_t)sigma * sizeof(int));
+    unsigned long long n = totalItems(freq, sigma);
+    BigInt rest, block;
+    int okRest = bigInit(&rest, n, 0) == 0;
+    int okBlock = bigInit(&block, n, 0) == 0;
+    if (!f || !okRest || !okBlock) {
+        bigFree(&arrangements);
+        bigFree(&rest);
+        bigFree(&block);
+        free(f);
+        return -1;
+    }
+    memcpy(f, freq, (size_t)sigma * sizeof(int));
+    bigCopy(&rest, k);
+
+    for (unsigned long long pos = 0, remaining = n; remaining > 0; pos++, remaining--) {
+        for (int s = 0; s < sigma; s++) {
+            if (f[s] == 0) continue;
+            bigCopy(&block, &arrangements);
+            bigMulSmall(&block, (uint32_t)f[s]);
+            bigDivSmall(&block, (uint32_t)remaining);
+            if (bigCompare(&rest, &block) < 0) {
+                perm[pos] = s;
+                f[s]--;
+                bigCopy(&arrangements, &block);
+                break;
+            }
+            bigSub(&rest, &block);
+        }
+    }
+    bigFree(&arrangements);
+    bigFree(&rest);
+    bigFree(&block);
+    free(f);
+    return 0;
+}
+
+int kthUniquePermutation(const int *freq, int sigma, unsigned long long k, int *perm) {
+    unsigned long long arrangements;
+    if (multinomialCount(freq, sigma, &arrangements) != 0) {
+        // Too many permutations for 64 bits; k itself still fits
+        BigInt big;
+        if (bigInit(&big, totalItems(freq, sigma), k) != 0) return -1;
+        int status = kthUniquePermutationBig(freq, sigma, &big, perm);
+        bigFree(&big);
+        return status;
+    }
+    if (k >= arrangements) return -1;
+
+    int *f = malloc((size_t)sigma * sizeof(int));
+    if (!f) return -1;
+    memcpy(f, freq, (size_t)sigma * sizeof(int));
+    unsigned long long n = totalItems(freq, sigma);
+    for (unsigned long long pos = 0, remaining = n; remaining > 0; pos++, remaining--) {
+        for (int s = 0; s < sigma; s++) {
+            if (f[s] == 0) continue;
+            unsigned long long block = (unsigned long long)((u128)arrangements * (unsigned)f[s] / remaining);
+            if (k < block) {
+                perm[pos] = s;
+                f[s]--;
+                arrangements = block;
+                break;
+            }
+            k -= block;
+        }
+    }
+    free(f);
+    return 0;
+}
+
+// Lexicographic rank of perm[0..n) among the distinct permutations of its own
+// symbols (each in 0..sigma-1). Returns 0, or -1 if a symbol is out of range or
+// memory runs out (rank is then left empty, so bigFree on it is still safe).
+int rankUniquePermutationBig(const int *perm, int n, int sigma, BigInt *rank) {
+    rank->limb = NULL;
+    rank->len = rank->cap = 0;
+    int *f = calloc((size_t)sigma, sizeof(int));
+    if (!f) return -1;
+    for (int i = 0; i < n; i++) {
+        if (perm[i] < 0 || perm[i] >= sigma) {
+            free(f);
+            return -1;
+        }
+        f[perm[i]]++;
+    }
+    BigInt arrangements, block;
+    int okCount = multinomialBig(f, sigma, &arrangements) == 0;
+    int okBlock = bigInit(&block, (unsigned long long)n, 0) == 0;
+    int okRank = bigInit(rank, (unsigned long long)n, 0) == 0;
+    if (!okCount || !okBlock || !okRank) {
+        bigFree(&arrangements);
+        bigFree(&block);
+        bigFree(rank);
+        free(f);
+        return -1;
+    }
+    for (int pos = 0, remaining = n; pos < n; pos++, remaining--) {
+        for (int s = 0; s < perm[pos]; s++) {
+            if (f[s] == 0) continue;
+            bigCopy(&block, &arrangements);
+            bigMulSmall(&block, (uint32_t)f[s]);
+            bigDivSmall(&block, (uint32_t)remaining);
+            bigAdd(rank, &block);
+        }
+        bigMulSmall(&arrangements, (uint32_t)f[perm[pos]]);
+        bigDivSmall(&arrangements, (uint32_t)remaining);
+        f[perm[pos]]--;
+    }
+    bigFree(&arrangements);
+    bigFree(&block);
+    free(f);
+    return 0;
+}
+
+// As rankUniquePermutationBig; also returns -1 if the rank needs more than 64 bits
+int rankUniquePermutation(const int *perm, int n, int sigma, unsigned long long *rank) {
+    int *f = calloc((size_t)sigma, sizeof(int));
+    if (!f) return -1;
+    for (int i = 0; i < n; i++) {
+        if (perm[i] < 0 || perm[i] >= sigma) {
+            free(f);
+            return -1;
+        }
+        f[perm[i]]++;
+    }
+    unsigned long long arrangements;
+    if (multinomialCount(f, sigma, &arrangements) != 0) {
+        free(f);
+        BigInt big;
+        int status = rankUniquePermutationBig(perm, n, sigma, &big);
+        if (status == 0 && big.len <= 2) {
+            *rank = big.limb[0] | (unsigned long long)big.limb[1] << 32;
+        } else {
+            status = -1;
+        }
+        bigFree(&big);
+        return status;
+    }
+
+    unsigned long long r = 0;
+    for (int pos = 0, remaining = n; pos < n; pos++, remaining--) {
+        for (int s = 0; s < perm[pos]; s++) {
+            if (f[s] > 0) r += (unsigned long long)((u128)arrangements * (unsigned)f[s] / (unsigned)remaining);
+        }
+        arrangements = (unsigned long long)((u128)arrangements * (unsigned)f[perm[pos]] / (unsigned)remaining);
+        f[perm[pos]]--;
+    }
+    free(f);
+    *rank = r;
+    return 0;
+}
+
+// One thread's share of writePermutationsParallel
+typedef struct {
+    int fd;
+    int n;
+    int distinct;               // no repeated digit: unrank through the factorial number system
+    int items[MAX_PERM_N];      // the digits in ascending order
+    int freq[MAX_DIGITS];
+    unsigned long long first;   // rank of the first line
+    unsigned long long count;   // number of lines
+    int failed;
+} PermChunk;
+
+// pwrite()s all len bytes at offset
+static int pwriteAll(int fd, const char *data, size_t len, off_t offset) {
+    while (len > 0) {
+        ssize_t done = pwrite(fd, data, len, offset);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += done;
+        len -= (size_t)done;
+        offset += done;
+    }
+    return 0;
+}
+
+static void *permChunkWorker(void *arg) {
+    PermChunk *c = arg;
+    size_t lineLen = (size_t)c->n + 1;
+    size_t linesPerBlock = WRITER_BUFFER_SIZE / lineLen;
+    char *buf;
+    if (c->count == 0) return NULL;
+    if (posix_memalign((void **)&buf, WRITER_ALIGN, linesPerBlock * lineLen) != 0) {
+        c->failed = 1;
+        return NULL;
+    }
+
+    int perm[MAX_PERM_N];
+    if (c->distinct) {
+        int index[MAX_PERM_N];
+        unrankPermutation(c->first, c->n, index);
+        for (int i = 0; i < c->n; i++) perm[i] = c->items[index[i]];
+    } else {
+        if (kthUniquePermutation(c->freq, MAX_DIGITS, c->first, perm) != 0) {
+            c->failed = 1;
+            free(buf);
+            return NULL;
+        }
+    }
+
+    off_t offset = (off_t)(c->first * lineLen);
+    unsigned long long left = c->count;
+    while (left > 0 && !c->failed) {
+        size_t lines = left < linesPerBlock ? (size_t)left : linesPerBlock;
+        char *p = buf;
+        for (size_t l = 0; l < lines; l++) {
+            for (int i = 0; i < c->n; i++) p[i] = (char)('0' + perm[i]);
+            p[c->n] = '\n';
+            p += lineLen;
+            nextPermutation(perm, c->n);
+        }
+        if (pwriteAll(c->fd, buf, lines * lineLen, offset) != 0) c->failed = 1;
+        offset += (off_t)(lines * lineLen);
+        left -= lines;
+    }
+    free(buf);
+    return NULL;
+}
+
+// ----------------------------------------------------
+// Function: writePermutationsParallel
+// Writes every distinct permutation of the digit multiset freq, in
+// lexicographic order, one per line, using `threads` threads
+// (<= 0: one per online CPU). Returns 0 on success, -1 on failure.
+// ----------------------------------------------------
+int writePermutationsParallel(const char *path, const int *freq, int threads) {
+    PermChunk proto;
+    memset(&proto, 0, sizeof proto);
+    proto.distinct = 1;
+    for (int d = 0; d < MAX_DIGITS; d++) {
+        if (freq[d] < 0 || proto.n + freq[d] > MAX_PERM_N) return -1;
+        proto.freq[d] = freq[d];
+        for (int j = 0; j < freq[d]; j++) proto.items[proto.n++] = d;
+        if (freq[d] > 1) proto.distinct = 0;
+    }
+
+    unsigned long long total;
+    if (multinomialCount(freq, MAX_DIGITS, &total) != 0) return -1;
+    size_t lineLen = (size_t)proto.n + 1;
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if (threads > PARALLEL_MAX_THREADS) threads = PARALLEL_MAX_THREADS;
+    if ((unsigned long long)threads > total) threads = (int)total;
+
+    proto.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (proto.fd < 0) return -1;
+    if (ftruncate(proto.fd, (off_t)(total * lineLen)) != 0) {
+        close(proto.fd);
+        return -1;
+    }
+
+    PermChunk chunks[PARALLEL_MAX_THREADS];
+    pthread_t tids[PARALLEL_MAX_THREADS];
+    int started[PARALLEL_MAX_THREADS] = {0};
+    for (int t = 0; t < threads; t++) {
+        unsigned long long begin = (unsigned long long)((u128)total * (unsigned)t / (unsigned)threads);
+        unsigned long long end = (unsigned long long)((u128)total * (unsigned)(t + 1) / (unsigned)threads);
+        chunks[t] = proto;
+        chunks[t].first = begin;
+        chunks[t].count = end - begin;
+    }
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&tids[t], NULL, permChunkWorker, &chunks[t]) == 0;
+        if (!started[t]) permChunkWorker(&chunks[t]);
+    }
+    permChunkWorker(&chunks[0]);
+
+    int failed = 0;
+    for (int t = 0; t < threads; t++) {
+        if (t > 0 && started[t]) pthread_join(tids[t], NULL);
+        failed |= chunks[t].failed;
+    }
+    if (close(proto.fd) != 0) failed = 1;
+    return failed ? -1 : 0;
+}
+
+// ----------------------------------------------------
+// Part 5: Binary formats and a streaming reader
+//
+// A binary file starts with an 8 byte header:
+//   "PERM", format, n, record width (0 if variable), 0
+// followed by one record per permutation:
+//
+//   PERM_FORMAT_NIBBLE     -> symbols < 16, two per byte, high nibble
+//                             first: ceil(n / 2) bytes (5 for 10 digits)
+//   PERM_FORMAT_LEHMER     -> permutations of 0..n-1 (n <= MAX_PERM_N):
+//                             the Lehmer code read as one mixed radix
+//                             number, i.e. rankPermutation, little endian
+//                             in the fewest bytes that hold n! - 1
+//                             (3 bytes for n = 10)
+//   PERM_FORMAT_RANK_DELTA -> same permutations, each stored as the
+//                             difference to the previous rank (the first
+//                             one to 0), zigzag + LEB128 varint. Sorted
+//                             output is one byte per permutation.
+//
+// Text files have no header. PermReader recognises all four formats and
+// hands back one permutation at a time from a 4 MB read() buffer.
+// ----------------------------------------------------
+#define PERM_HEADER_SIZE 8
+
+static const char *permFormatName(PermFormat format) {
+    switch (format) {
+        case PERM_FORMAT_NIBBLE: return "nibble";
+        case PERM_FORMAT_LEHMER: return "lehmer";
+        case PERM_FORMAT_RANK_DELTA: return "rank-delta";
+        default: return "text";
+    }
+}
+
+// Bytes per record, 0 for the variable length rank-delta stream
+static int permRecordWidth(PermFormat format, int n) {
+    switch (format) {
+        case PERM_FORMAT_TEXT: return n + 1;
+        case PERM_FORMAT_NIBBLE: return (n + 1) / 2;
+        case PERM_FORMAT_LEHMER: {
+            unsigned long long last = factorial(n) - 1;
+            int width = 1;
+            while (width < 8 && (last >> (8 * width)) != 0) width++;
+            return width;
+        }
+        default: return 0;
+    }
+}
+
+// Like writerOpen, for `count` permutations of n symbols in the given format.
+// The rank-delta stream has no size known up front and is always buffered.
+int writerOpenFormat(PermWriter *w, const char *path, WriterMode mode, PermFormat format, int n, size_t count) {
+    int width = permRecordWidth(format, n);
+    if (n < 0 || n > 255 || (format == PERM_FORMAT_NIBBLE && n == 0) || ((format == PERM_FORMAT_LEHMER || format == PERM_FORMAT_RANK_DELTA) && n > MAX_PERM_N)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (format == PERM_FORMAT_TEXT) return writerOpen(w, path, mode, count * (size_t)width);
+    if (format == PERM_FORMAT_RANK_DELTA) mode = WRITER_BUFFERED;
+    if (writerOpen(w, path, mode, PERM_HEADER_SIZE + count * (size_t)width) != 0) return -1;
+
+    w->format = format;
+    w->n = n;
+    w->width = width;
+    char header[PERM_HEADER_SIZE] = {'P', 'E', 'R', 'M', (char)format, (char)n, (char)width, 0};
+    if (w->cap < PERM_HEADER_SIZE) {
+        w->failed = 1;
+    } else {
+        memcpy(w->buf, header, PERM_HEADER_SIZE);
+        w->pos = PERM_HEADER_SIZE;
+    }
+    return 0;
+}
+
+// A record that does not fit its format (wrong length, a symbol >= 16, or for
+// lehmer / rank-delta not a permutation of 0..n-1) is not written; the writer
+// is marked failed instead, which also stops writerVisitor.
+static void writerPutBinary(PermWriter *w, const int *perm, int n) {
+    unsigned char record[128];
+    int len = 0;
+    if (n != w->n) {
+        w->failed = 1;
+        return;
+    }
+    if (w->format == PERM_FORMAT_NIBBLE) {
+        for (int i = 0; i < n; i++) {
+            if (perm[i] < 0 || perm[i] > 15) {
+                w->failed = 1;
+                return;
+            }
+        }
+        for (int i = 0; i < n; i += 2) {
+            int low = i + 1 < n ? perm[i + 1] : 0;
+            record[len++] = (unsigned char)(perm[i] << 4 | low);
+        }
+    } else {
+        unsigned seen = 0;
+        for (int i = 0; i < n; i++) {
+            if (perm[i] < 0 || perm[i] >= n || (seen >> perm[i] & 1)) {
+                w->failed = 1;
+                return;
+            }
+            seen |= 1u << perm[i];
+        }
+        unsigned long long rank = rankPermutation(perm, n);
+        if (w->format == PERM_FORMAT_LEHMER) {
+            for (; len < w->width; len++) record[len] = (unsigned char)(rank >> (8 * len));
+        } else {
+            long long delta = (long long)(rank - w->prevRank);
+            unsigned long long zigzag = ((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63);
+            w->prevRank = rank;
+            do {
+                record[len++] = (unsigned char)((zigzag & 0x7f) | (zigzag > 0x7f ? 0x80 : 0));
+                zigzag >>= 7;
+            } while (zigzag);
+        }
+    }
+
+    if (w->pos + (size_t)len > w->cap) {
+        if (w->mode == WRITER_MMAP) {
+            w->failed = 1;
+            return;
+        }
+        writerFlush(w);
+    }
+    memcpy(w->buf + w->pos, record, (size_t)len);
+    w->pos += (size_t)len;
+}
+
+typedef struct {
+    int fd;
+    PermFormat format;
+    int n;
+    int width;
+    unsigned char *buf;
+    size_t pos;     // next unread byte in buf
+    size_t len;     // bytes in buf
+    int eof;
+    unsigned long long rank;    // PERM_FORMAT_RANK_DELTA state
+    unsigned long long limit;   // n!, the first invalid rank
+} PermReader;
+
+// Makes at least `need` unread bytes available unless the file ends first;
+// returns how many there are
+static size_t readerFill(PermReader *r, size_t need) {
+    if (r->len - r->pos >= need || r->eof) return r->len - r->pos;
+    memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+    r->len -= r->pos;
+    r->pos = 0;
+    while (r->len < need && !r->eof) {
+        ssize_t got = read(r->fd, r->buf + r->len, WRITER_BUFFER_SIZE - r->len);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) r->eof = 1;
+        else r->len += (size_t)got;
+    }
+    return r->len;
+}
+
+// Opens a file written by PermWriter in any format. maxN is the capacity of
+// the perm array that will be passed to readerNext; files with longer records
+// are rejected. Returns 0, or -1 if it cannot be read or is not a permutation
+// file of at most maxN symbols.
+int readerOpen(PermReader *r, const char *path, int maxN) {
+    memset(r, 0, sizeof *r);
+    r->fd = open(path, O_RDONLY);
+    if (r->fd < 0) return -1;
+    r->buf = malloc(WRITER_BUFFER_SIZE);
+    if (!r->buf) {
+        close(r->fd);
+        return -1;
+    }
+
+    size_t have = readerFill(r, PERM_HEADER_SIZE);
+    if (have >= PERM_HEADER_SIZE && memcmp(r->buf, "PERM", 4) == 0) {
+        r->format = (PermFormat)r->buf[4];
+        r->n = r->buf[5];
+        r->width = r->buf[6];
+        r->pos = PERM_HEADER_SIZE;
+        if (r->format > PERM_FORMAT_RANK_DELTA || r->format == PERM_FORMAT_TEXT ||
+            r->width != permRecordWidth(r->format, r->n) || (r->format == PERM_FORMAT_NIBBLE && r->n == 0) ||
+            r->n > maxN || (r->format != PERM_FORMAT_NIBBLE && r->n > MAX_PERM_N)) {
+            errno = EINVAL;
+            goto fail;
+        }
+        if (r->format != PERM_FORMAT_NIBBLE) r->limit = factorial(r->n);
+        return 0;
+    }
+
+    // Text: the first line gives n
+    have = readerFill(r, (size_t)maxN + 1);
+    r->format = PERM_FORMAT_TEXT;
+    while (r->n < (int)have && r->n <= maxN && r->buf[r->n] != '\n') r->n++;
+    if (have > 0 && (r->n == (int)have || r->n > maxN)) {
+        errno = EINVAL;
+        goto fail;
+    }
+    r->width = r->n + 1;
+    return 0;
+
+fail:
+    close(r->fd);
+    free(r->buf);
+    r->buf = NULL;
+    return -1;
+}
+
+// Stores the next permutation in perm[0..r->n), r->n <= the maxN given to
+// readerOpen. Returns 1, 0 at the end of
+// the file, or -1 on a truncated or malformed record.
+int readerNext(PermReader *r, int *perm) {
+    int n = r->n;
+    if (r->format == PERM_FORMAT_RANK_DELTA) {
+        size_t have = readerFill(r, 10);     // the longest 64-bit varint
+        if (have == 0) return 0;
+        unsigned long long zigzag = 0;
+        for (int shift = 0;; shift += 7) {
+            if (have == 0 || shift > 63) return -1;
+            unsigned char byte = r->buf[r->pos++];
+            have--;
+            zigzag |= (unsigned long long)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        r->rank += (zigzag >> 1) ^ (0 - (zigzag & 1));
+        if (r->rank >= r->limit) return -1;
+        unrankPermutation(r->rank, n, perm);
+        return 1;
+    }
+
+    size_t have = readerFill(r, (size_t)r->width);
+    if (have == 0) return 0;
+    if (have < (size_t)r->width) return -1;
+    const unsigned char *p = r->buf + r->pos;
+    r->pos += (size_t)r->width;
+
+    if (r->format == PERM_FORMAT_TEXT) {
+        if (p[n] != '\n') return -1;
+        for (int i = 0; i < n; i++) perm[i] = p[i] - '0';
+    } else if (r->format == PERM_FORMAT_NIBBLE) {
+        for (int i = 0; i < n; i++) perm[i] = (i & 1) ? (p[i / 2] & 15) : (p[i / 2] >> 4);
+    } else {
+        unsigned long long rank = 0;
+        for (int i = r->width; i-- > 0;) rank = rank << 8 | p[i];
+        if (rank >= r->limit) return -1;
+        unrankPermutation(rank, n, perm);
+    }
+    return 1;
+}
+
+void readerClose(PermReader *r) {
+    close(r->fd);
+    free(r->buf);
+    r->buf = NULL;
+    r->fd = -1;
 }
 
 // ----------------------------------------------------
@@ -157,26 +1262,228 @@ void printDuplicates(int *arr, int n) {
         printf("No duplicates found.\n");
 }
 
+// ----------------------------------------------------
+// Function: printMultinomial
+// ./main --count f0 f1 ... prints the exact number of distinct
+// permutations of a multiset with those symbol frequencies
+// ----------------------------------------------------
+int printMultinomial(int sigma, char **args) {
+    if (sigma < 1) {
+        printf("Error: usage ./main --count f0 f1 ...!\n");
+        return 1;
+    }
+    int *freq = malloc((size_t)sigma * sizeof(int));
+    if (!freq) {
+        printf("Error: out of memory!\n");
+        return 1;
+    }
+    for (int s = 0; s < sigma; s++) {
+        freq[s] = atoi(args[s]);
+        if (freq[s] < 0) {
+            printf("Error: negative frequency!\n");
+            free(freq);
+            return 1;
+        }
+    }
+
+    unsigned long long count;
+    int status = 0;
+    if (multinomialCount(freq, sigma, &count) == 0) {
+        printf("%llu\n", count);
+    } else {
+        BigInt big;
+        char *text = multinomialBig(freq, sigma, &big) == 0 ? bigToDecimal(&big) : NULL;
+        if (text) {
+            printf("%s (more than 64 bits)\n", text);
+        } else {
+            printf("Error: out of memory!\n");
+            status = 1;
+        }
+        free(text);
+        bigFree(&big);
+    }
+    free(freq);
+    return status;
+}
+
+// Wall clock seconds, for the timing lines printed by main
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ----------------------------------------------------
+// Function: writeBinaryExample
+// ./main --format nibble|lehmer|rank-delta writes the permutations of 0–9
+// to permutations.bin in that format and streams the file back
+// ----------------------------------------------------
+int writeBinaryExample(const char *name) {
+    PermFormat format = PERM_FORMAT_TEXT;
+    while (format <= PERM_FORMAT_RANK_DELTA && strcmp(permFormatName(format), name) != 0) format++;
+    if (format > PERM_FORMAT_RANK_DELTA) {
+        printf("Error: unknown format %s!\n", name);
+        return 1;
+    }
+
+    int digits[MAX_DIGITS];
+    for (int i = 0; i < MAX_DIGITS; i++) digits[i] = i;
+
+    PermWriter out;
+    double start = nowSeconds();
+    if (writerOpenFormat(&out, "permutations.bin", WRITER_MMAP, format, MAX_DIGITS, (size_t)factorial(MAX_DIGITS)) != 0) {
+        printf("Error opening file!\n");
+        return 1;
+    }
+    generatePermutations(digits, 0, MAX_DIGITS - 1, writerVisitor, NULL, &out);
+    size_t bytes = out.pos;
+    if (writerClose(&out) != 0) {
+        printf("Error writing permutations.bin!\n");
+        return 1;
+    }
+    double written = nowSeconds();
+
+    PermReader in;
+    if (readerOpen(&in, "permutations.bin", MAX_PERM_N) != 0) {
+        printf("Error reading permutations.bin!\n");
+        return 1;
+    }
+    int perm[MAX_PERM_N];
+    unsigned long long count = 0;
+    int status;
+    while ((status = readerNext(&in, perm)) == 1) {
+        unsigned seen = 0;
+        for (int i = 0; i < in.n; i++) {
+            if (perm[i] < 0 || perm[i] >= MAX_DIGITS) status = -1;
+            else seen |= 1u << perm[i];
+        }
+        if (seen != (1u << MAX_DIGITS) - 1) status = -1;
+        if (status != 1) break;
+        count++;
+    }
+    readerClose(&in);
+    if (status != 0) {
+        printf("Error: bad record after %llu permutations!\n", count);
+        return 1;
+    }
+
+    printf("permutations.bin: %s format, %zu bytes (text: %zu), written in %.3f s\n", permFormatName(format), bytes,
+           (size_t)factorial(MAX_DIGITS) * (MAX_DIGITS + 1), written - start);
+    printf("Read back %llu permutations in %.3f s\n", count, nowSeconds() - written);
+    return 0;
+}
+
+// ----------------------------------------------------
+// Benchmark: ./main --bench [maxN]
+// Runs every generator over all n! permutations of 0..n-1 for
+// n = 8..maxN (default 12) and prints ns per permutation. The recursive
+// row is generatePermutations with a visitor that feeds the same
+// one-word checksum as the iterators, so only generation is measured.
+// ----------------------------------------------------
+#define BENCH_DEFAULT_MAX_N 12
+
+static int checksumVisitor(const int *perm, int n, void *ctx) {
+    (void)n;
+    *(unsigned long long *)ctx += (unsigned)perm[0];
+    return 0;
+}
+
+static int runGeneratorBenchmark(int maxN) {
+    static const char *names[] = {"heap", "lexicographic", "plain changes", "ehrlich"};
+    if (maxN > MAX_PERM_N) maxN = MAX_PERM_N;
+
+    printf("%3s %14s %10s %14s %14s %14s %14s\n", "n", "permutations", "recursive",
+           names[0], names[1], names[2], names[3]);
+    for (int n = 8; n <= maxN; n++) {
+        int items[MAX_PERM_N];
+        for (int i = 0; i < n; i++) items[i] = i;
+        unsigned long long sink = 0, count = 0;
+
+        double start = nowSeconds();
+        generatePermutations(items, 0, n - 1, checksumVisitor, NULL, &sink);
+        double recursive = nowSeconds() - start;
+
+        double per[4];
+        for (int a = 0; a < 4; a++) {
+            PermIterator it;
+            permIterInit(&it, (PermAlgorithm)a, items, n);
+            count = 0;
+            start = nowSeconds();
+            while (permIterNext(&it)) {
+                sink += (unsigned)it.perm[0];
+                count++;
+            }
+            per[a] = (nowSeconds() - start) * 1e9 / count;
+        }
+        printf("%3d %14llu %8.2fns %12.2fns %12.2fns %12.2fns %12.2fns\n", n, count,
+               recursive * 1e9 / count, per[0], per[1], per[2], per[3]);
+        if (sink == 42) printf(" ");   // keeps the checksum alive
+    }
+    return 0;
+}
+
 // ----------------------------------------------------
 // MAIN FUNCTION
+// Usage: ./main [--buffered]
+//   default      -> permutations.txt is written through mmap
+//   --buffered   -> 4 MB write() blocks instead
+//        ./main --bench [maxN]
 // ----------------------------------------------------
-int main() {
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return runGeneratorBenchmark(argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_MAX_N);
+
+    if (argc > 1 && strcmp(argv[1], "--format") == 0)
+        return writeBinaryExample(argc > 2 ? argv[2] : "nibble");
+    if (argc > 1 && strcmp(argv[1], "--count") == 0)
+        return printMultinomial(argc - 2, argv + 2);
+
+    WriterMode mode = (argc > 1 && strcmp(argv[1], "--buffered") == 0) ? WRITER_BUFFERED : WRITER_MMAP;
+    int parallel = argc > 1 && strcmp(argv[1], "--parallel") == 0;
+    int threads = (parallel && argc > 2) ? atoi(argv[2]) : 0;   // 0: one per CPU
+
     // ------------------------
     // Example 1: Distinct digits 0–9
     // ------------------------
     int digits[MAX_DIGITS];
     for (int i = 0; i < MAX_DIGITS; i++) digits[i] = i;
 
-    FILE *fptr = fopen("permutations.txt", "w");
-    if (!fptr) {
-        printf("Error opening file!\n");
-        return 1;
+    size_t lines = 1;
+    for (int i = 2; i <= MAX_DIGITS; i++) lines *= (size_t)i;
+
+    if (parallel) {
+        // Lexicographic order instead of the swap order of generatePermutations
+        int ones[MAX_DIGITS];
+        for (int i = 0; i < MAX_DIGITS; i++) ones[i] = 1;
+        printf("Generating all permutations of 0–9 in parallel (lexicographic order)...\n");
+        double start = nowSeconds();
+        if (writePermutationsParallel("permutations.txt", ones, threads) != 0) {
+            printf("Error writing permutations.txt!\n");
+            return 1;
+        }
+        printf("All permutations saved in permutations.txt (%.3f s, pwrite)\n", nowSeconds() - start);
+    } else {
+        PermWriter out;
+        if (writerOpen(&out, "permutations.txt", mode, lines * (MAX_DIGITS + 1)) != 0) {
+            printf("Error opening file!\n");
+            return 1;
+        }
+
+        printf("Generating all permutations of 0–9 (10! = 3,628,800)...\n");
+        double start = nowSeconds();
+        generatePermutations(digits, 0, MAX_DIGITS - 1, writerVisitor, NULL, &out);
+        if (writerClose(&out) != 0) {
+            printf("Error writing permutations.txt!\n");
+            return 1;
+        }
+        printf("All permutations saved in permutations.txt (%.3f s, %s)\n", nowSeconds() - start,
+               mode == WRITER_MMAP ? "mmap" : "buffered write");
     }
 
-    printf("Generating all permutations of 0–9 (10! = 3,628,800)...\n");
-    generatePermutations(digits, 0, MAX_DIGITS - 1, fptr);
-    fclose(fptr);
-    printf("All permutations saved in permutations.txt\n");
+    // Same generator, counting instead of writing and skipping every prefix "0"
+    unsigned long long noZeroCount = 0;
+    generatePermutations(digits, 0, MAX_DIGITS - 1, countVisitor, noLeadingZero, &noZeroCount);
+    printf("Permutations without a leading zero: %llu\n", noZeroCount);
 
     // ------------------------
     // Example 2: Array with duplicates
@@ -191,20 +1498,42 @@ int main() {
     // Print duplicate info
     printDuplicates(arr, n);
 
-    FILE *fptr2 = fopen("unique_permutations.txt", "w");
-    if (!fptr2) {
+    unsigned long long uniqueCount;
+    multinomialCount(freq, MAX_DIGITS, &uniqueCount);
+    printf("Number of unique permutations: %llu\n", uniqueCount);
+
+    if (parallel) {
+        if (writePermutationsParallel("unique_permutations.txt", freq, threads) != 0) {
+            printf("Error writing unique_permutations.txt!\n");
+            return 1;
+        }
+        printf("Unique permutations saved in unique_permutations.txt\n");
+        return 0;
+    }
+
+    // uniqueCount lines of n + 1 bytes each
+    PermWriter out2;
+    if (writerOpen(&out2, "unique_permutations.txt", mode, (size_t)uniqueCount * (size_t)(n + 1)) != 0) {
         printf("Error opening file!\n");
         return 1;
     }
 
     // Store current permutation being built
     int *result = (int *)malloc(n * sizeof(int));
+    if (!result) {
+        writerClose(&out2);
+        printf("Error allocating memory!\n");
+        return 1;
+    }
 
     printf("Generating unique permutations for array with duplicates...\n");
-    generateUniquePermutations(freq, n, 0, result, fptr2);
+    generateUniquePermutations(freq, n, 0, result, writerVisitor, NULL, &out2);
 
-    fclose(fptr2);
     free(result);
+    if (writerClose(&out2) != 0) {
+        printf("Error writing unique_permutations.txt!\n");
+        return 1;
+    }
 
     printf("Unique permutations saved in unique_permutations.txt\n");
 